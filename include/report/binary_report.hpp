@@ -0,0 +1,638 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_May_02_binary_report
+#define GUARD_2024_May_02_binary_report
+
+#include "report/report.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/serialization/serialization.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace report
+{
+
+/***
+    Binary report format
+
+    A flat file of records that can be memory mapped and traversed without loading the
+    whole report.  Every Container is one record and a Branch or Table record holds the
+    file offsets of its child records rather than the children themselves.  Children are
+    written before their parents so the root record is last and its offset is stored in
+    the trailer.
+
+        header:     "REPORTB" u32 version u32 byte order marker
+        records:    u8 Container index followed by the fields of the element
+                    Branch: label, bookmark, vec< u64 child offset >
+                    Table:  headings, vec< vec< u64 cell offset > >
+        trailer:    u64 root offset "REPORTB"
+
+    Numbers are stored in host byte order which the reader checks against the marker.
+    Values are stored as their variant index and alternative.  Alternatives which are not
+    arithmetic, enum or string types are stored through their boost::serialization
+    serialize member or function so the types of an existing Value need no changes.
+*/
+
+// Appends values to a flat buffer for the binary report format
+class BinaryOArchive
+{
+public:
+    using is_saving  = std::true_type;
+    using is_loading = std::false_type;
+
+    explicit BinaryOArchive( std::string& strBuffer )
+        : m_strBuffer( strBuffer )
+    {
+    }
+
+    template < typename T >
+    inline BinaryOArchive& operator&( const T& value )
+    {
+        save( value );
+        return *this;
+    }
+
+    inline void saveBytes( const void* pData, std::size_t szSize )
+    {
+        m_strBuffer.append( static_cast< const char* >( pData ), szSize );
+    }
+
+    inline void saveSize( std::size_t szSize )
+    {
+        const std::uint64_t uiSize = szSize;
+        saveBytes( &uiSize, sizeof( uiSize ) );
+    }
+
+private:
+    template < typename T >
+    inline void save( const T& value )
+    {
+        if constexpr( std::is_arithmetic_v< T > || std::is_enum_v< T > )
+        {
+            saveBytes( &value, sizeof( T ) );
+        }
+        else
+        {
+            boost::serialization::serialize( *this, const_cast< T& >( value ), 0U );
+        }
+    }
+
+    template < typename Char, typename Traits, typename Allocator >
+    inline void save( const std::basic_string< Char, Traits, Allocator >& str )
+    {
+        saveSize( str.size() );
+        saveBytes( str.data(), str.size() * sizeof( Char ) );
+    }
+
+    template < typename T, typename Allocator >
+    inline void save( const std::vector< T, Allocator >& vector )
+    {
+        saveSize( vector.size() );
+        for( const T& element : vector )
+        {
+            save( element );
+        }
+    }
+
+    template < typename T >
+    inline void save( const std::optional< T >& valueOpt )
+    {
+        save( valueOpt.has_value() );
+        if( valueOpt.has_value() )
+        {
+            save( valueOpt.value() );
+        }
+    }
+
+    template < typename... Types >
+    inline void save( const std::variant< Types... >& variant )
+    {
+        saveSize( variant.index() );
+        std::visit( [ this ]( const auto& alternative ) { save( alternative ); }, variant );
+    }
+
+    std::string& m_strBuffer;
+};
+
+namespace detail
+{
+// calls function with alternative szIndex of variant after default constructing it
+template < std::size_t I = 0U, typename Variant, typename Function >
+inline void emplaceAlternative( Variant& variant, std::size_t szIndex, Function&& function )
+{
+    if constexpr( I < std::variant_size_v< Variant > )
+    {
+        if( szIndex == I )
+        {
+            function( variant.template emplace< I >() );
+        }
+        else
+        {
+            emplaceAlternative< I + 1U >( variant, szIndex, std::forward< Function >( function ) );
+        }
+    }
+    else
+    {
+        THROW_RTE( "Invalid variant index in binary report: " << szIndex );
+    }
+}
+} // namespace detail
+
+// Reads values written by BinaryOArchive from a mapped record.  Every read is bounds checked
+// against the record data.  BinaryReport checks the record offsets themselves.
+class BinaryIArchive
+{
+public:
+    using is_saving  = std::false_type;
+    using is_loading = std::true_type;
+
+    explicit BinaryIArchive( std::string_view data )
+        : m_data( data )
+    {
+    }
+
+    template < typename T >
+    inline BinaryIArchive& operator&( T& value )
+    {
+        load( value );
+        return *this;
+    }
+
+    inline void loadBytes( void* pData, std::size_t szSize )
+    {
+        VERIFY_RTE_MSG( szSize <= m_data.size(), "Binary report is truncated" );
+        std::memcpy( pData, m_data.data(), szSize );
+        m_data.remove_prefix( szSize );
+    }
+
+    // sizes are bounded by the remaining data so a corrupt size fails rather than allocating
+    inline std::size_t loadSize()
+    {
+        std::uint64_t uiSize = 0U;
+        loadBytes( &uiSize, sizeof( uiSize ) );
+        VERIFY_RTE_MSG( uiSize <= m_data.size(), "Invalid size in binary report: " << uiSize );
+        return static_cast< std::size_t >( uiSize );
+    }
+
+private:
+    template < typename T >
+    inline void load( T& value )
+    {
+        if constexpr( std::is_arithmetic_v< T > || std::is_enum_v< T > )
+        {
+            loadBytes( &value, sizeof( T ) );
+        }
+        else
+        {
+            boost::serialization::serialize( *this, value, 0U );
+        }
+    }
+
+    template < typename Char, typename Traits, typename Allocator >
+    inline void load( std::basic_string< Char, Traits, Allocator >& str )
+    {
+        str.resize( loadSize() );
+        loadBytes( str.data(), str.size() * sizeof( Char ) );
+    }
+
+    template < typename T, typename Allocator >
+    inline void load( std::vector< T, Allocator >& vector )
+    {
+        vector.resize( loadSize() );
+        for( T& element : vector )
+        {
+            load( element );
+        }
+    }
+
+    template < typename T >
+    inline void load( std::optional< T >& valueOpt )
+    {
+        bool bHasValue = false;
+        load( bHasValue );
+        if( bHasValue )
+        {
+            load( valueOpt.emplace() );
+        }
+        else
+        {
+            valueOpt.reset();
+        }
+    }
+
+    template < typename... Types >
+    inline void load( std::variant< Types... >& variant )
+    {
+        detail::emplaceAlternative( variant, loadSize(), [ this ]( auto& alternative ) { load( alternative ); } );
+    }
+
+    std::string_view m_data;
+};
+
+// Writes the header, records and trailer of a binary report to a stream
+class BinaryReportWriter
+{
+public:
+    explicit BinaryReportWriter( std::ostream& os );
+
+    // returns the offset of the record
+    std::uint64_t append( std::string_view strRecord );
+    void          finish( std::uint64_t uiRootOffset );
+
+private:
+    std::ostream& m_os;
+    std::uint64_t m_uiOffset = 0U;
+};
+
+// A memory mapped binary report.  Only the pages of the records that are read are loaded.
+class MappedBinaryReport
+{
+public:
+    explicit MappedBinaryReport( const boost::filesystem::path& filePath );
+
+    // the data from the record at uiOffset to the end of the records
+    std::string_view record( std::uint64_t uiOffset ) const;
+    std::uint64_t    getRootOffset() const { return m_uiRootOffset; }
+
+private:
+    boost::iostreams::mapped_file_source m_file;
+    std::string_view                     m_records;
+    std::uint64_t                        m_uiRootOffset = 0U;
+};
+
+namespace detail
+{
+// The fields of each element in the binary format.  One function serves both archives in the
+// same way as the serialize members.  Unlike those these include the colours and edge labels.
+template < typename Archive, typename Value >
+inline void binaryFields( Archive& archive, Line< Value >& line )
+{
+    archive& line.m_element;
+    archive& line.m_url;
+    archive& line.m_bookmark;
+    archive& line.m_colour;
+    archive& line.m_background_colour;
+}
+
+template < typename Archive, typename Value >
+inline void binaryFields( Archive& archive, Multiline< Value >& multiline )
+{
+    archive& multiline.m_elements;
+    archive& multiline.m_url;
+    archive& multiline.m_bookmark;
+    archive& multiline.m_colour;
+    archive& multiline.m_background_colour;
+}
+
+template < typename Archive, typename Value >
+inline void binaryFields( Archive& archive, Plot< Value >& plot )
+{
+    archive& plot.m_heading;
+    archive& plot.m_points;
+    archive& plot.m_style;
+}
+
+template < typename Archive, typename Vector, typename Function >
+inline void binaryVector( Archive& archive, Vector& vector, Function&& function )
+{
+    if constexpr( Archive::is_saving::value )
+    {
+        archive.saveSize( vector.size() );
+    }
+    else
+    {
+        vector.resize( archive.loadSize() );
+    }
+    for( auto& element : vector )
+    {
+        function( element );
+    }
+}
+
+template < typename Archive, typename Value >
+inline void binaryFields( Archive& archive, Graph< Value >& graph )
+{
+    binaryVector( archive, graph.m_nodes,
+                  [ &archive ]( auto& node )
+                  {
+                      archive& node.m_rows;
+                      archive& node.m_colour;
+                      archive& node.m_url;
+                      archive& node.m_bookmark;
+                      archive& node.m_background_colour;
+                      archive& node.m_border_width;
+                  } );
+    binaryVector( archive, graph.m_edges,
+                  [ &archive ]( auto& edge )
+                  {
+                      archive& edge.m_source;
+                      archive& edge.m_target;
+                      archive& edge.m_colour;
+                      archive& edge.m_style;
+                      archive& edge.m_bIgnoreInLayout;
+                      archive& edge.line_width;
+                      archive& edge.m_label;
+                  } );
+    binaryVector( archive, graph.m_subgraphs,
+                  [ &archive ]( auto& subgraph )
+                  {
+                      archive& subgraph.m_rows;
+                      archive& subgraph.m_nodes;
+                      archive& subgraph.m_colour;
+                      archive& subgraph.m_url;
+                      archive& subgraph.m_bookmark;
+                  } );
+    archive& graph.m_rankDirection;
+}
+
+template < typename Value >
+inline std::uint64_t writeBinaryContainer( BinaryReportWriter& writer, const Container< Value >& container )
+{
+    std::string    strRecord;
+    BinaryOArchive archive( strRecord );
+
+    const std::uint8_t uiType = static_cast< std::uint8_t >( container.index() );
+    std::visit(
+        [ & ]( const auto& element )
+        {
+            using T = std::decay_t< decltype( element ) >;
+            if constexpr( std::is_same_v< T, Branch< Value > > )
+            {
+                std::vector< std::uint64_t > offsets;
+                offsets.reserve( element.m_elements.size() );
+                for( const Container< Value >& child : element.m_elements )
+                {
+                    offsets.push_back( writeBinaryContainer( writer, child ) );
+                }
+                archive& uiType;
+                archive& element.m_label;
+                archive& element.m_bookmark;
+                archive& offsets;
+            }
+            else if constexpr( std::is_same_v< T, Table< Value > > )
+            {
+                std::vector< std::vector< std::uint64_t > > rows;
+                rows.reserve( element.m_rows.size() );
+                for( const ContainerVector< Value >& row : element.m_rows )
+                {
+                    std::vector< std::uint64_t >& offsets = rows.emplace_back();
+                    offsets.reserve( row.size() );
+                    for( const Container< Value >& cell : row )
+                    {
+                        offsets.push_back( writeBinaryContainer( writer, cell ) );
+                    }
+                }
+                archive& uiType;
+                archive& element.m_headings;
+                archive& rows;
+            }
+            else
+            {
+                archive& uiType;
+                binaryFields( archive, const_cast< T& >( element ) );
+            }
+        },
+        container );
+
+    return writer.append( strRecord );
+}
+
+template < typename T, typename Variant >
+struct VariantIndex;
+
+template < typename T, typename... Types >
+struct VariantIndex< T, std::variant< Types... > >
+{
+    static constexpr std::size_t value = []()
+    {
+        constexpr bool matches[] = { std::is_same_v< T, Types >... };
+        std::size_t    szIndex   = 0U;
+        while( !matches[ szIndex ] )
+        {
+            ++szIndex;
+        }
+        return szIndex;
+    }();
+};
+} // namespace detail
+
+// Writes report to os in the binary report format
+template < typename Value >
+inline void writeBinaryReport( const Container< Value >& report, std::ostream& os )
+{
+    BinaryReportWriter writer( os );
+    writer.finish( detail::writeBinaryContainer( writer, report ) );
+}
+
+/***
+    BinaryReport< Value >
+
+    Opens a binary report written by writeBinaryReport for the same Value type.  The tree
+    is navigated through lightweight Elements that decode only their own record.  load
+    decodes the subtree of an Element into an ordinary Container which can be rendered.
+
+        BinaryReport< Value > report( "nightly.report" );
+        for( const auto& element : report.root().elements() )
+            if( element.label() == wanted )
+                renderHTML( element.load(), os );
+
+    The BinaryReport must outlive the Elements obtained from it.
+*/
+template < typename Value >
+class BinaryReport
+{
+public:
+    class Element
+    {
+        friend class BinaryReport;
+
+    public:
+        // the index of the alternative within Container< Value >
+        std::size_t index() const { return m_uiType; }
+
+        template < typename T >
+        bool is() const
+        {
+            return m_uiType == detail::VariantIndex< T, Container< Value > >::value;
+        }
+
+        // the label of a Branch or the headings of a Table
+        ValueVector< Value > label() const
+        {
+            ValueVector< Value > label;
+            if( is< Branch< Value > >() || is< Table< Value > >() )
+            {
+                BinaryIArchive archive = open();
+                archive&       label;
+            }
+            return label;
+        }
+
+        // the elements of a Branch
+        std::vector< Element > elements() const
+        {
+            std::vector< Element > elements;
+            if( is< Branch< Value > >() )
+            {
+                BinaryIArchive               archive = open();
+                ValueVector< Value >         label;
+                Boxed< Value >               bookmark;
+                std::vector< std::uint64_t > offsets;
+                archive& label;
+                archive& bookmark;
+                archive& offsets;
+                for( std::uint64_t uiOffset : offsets )
+                {
+                    elements.push_back( child( uiOffset ) );
+                }
+            }
+            return elements;
+        }
+
+        // the cells of each row of a Table
+        std::vector< std::vector< Element > > rows() const
+        {
+            std::vector< std::vector< Element > > rows;
+            if( is< Table< Value > >() )
+            {
+                BinaryIArchive                              archive = open();
+                ValueVector< Value >                        headings;
+                std::vector< std::vector< std::uint64_t > > offsets;
+                archive& headings;
+                archive& offsets;
+                for( const auto& rowOffsets : offsets )
+                {
+                    std::vector< Element >& row = rows.emplace_back();
+                    for( std::uint64_t uiOffset : rowOffsets )
+                    {
+                        row.push_back( child( uiOffset ) );
+                    }
+                }
+            }
+            return rows;
+        }
+
+        // decodes the element and everything below it
+        Container< Value > load() const
+        {
+            BinaryIArchive     archive = open();
+            Container< Value > container;
+            detail::emplaceAlternative( container, m_uiType,
+                                        [ & ]( auto& element ) { loadElement( archive, element ); } );
+            return container;
+        }
+
+    private:
+        Element( const BinaryReport& report, std::uint64_t uiOffset )
+            : m_pReport( &report )
+            , m_uiOffset( uiOffset )
+        {
+            BinaryIArchive archive( m_pReport->m_file.record( m_uiOffset ) );
+            archive&       m_uiType;
+        }
+
+        // children are always written before their parent so any other offset is corrupt and is
+        // rejected before it can lead load() round a cycle
+        Element child( std::uint64_t uiOffset ) const
+        {
+            VERIFY_RTE_MSG( uiOffset < m_uiOffset, "Invalid child record offset in binary report: " << uiOffset );
+            return m_pReport->element( uiOffset );
+        }
+
+        // an archive positioned after the record type
+        BinaryIArchive open() const
+        {
+            BinaryIArchive archive( m_pReport->m_file.record( m_uiOffset ) );
+            std::uint8_t   uiType = 0U;
+            archive&       uiType;
+            return archive;
+        }
+
+        void loadElement( BinaryIArchive& archive, Branch< Value >& branch ) const
+        {
+            std::vector< std::uint64_t > offsets;
+            archive& branch.m_label;
+            archive& branch.m_bookmark;
+            archive& offsets;
+            for( std::uint64_t uiOffset : offsets )
+            {
+                branch.m_elements.push_back( child( uiOffset ).load() );
+            }
+        }
+
+        void loadElement( BinaryIArchive& archive, Table< Value >& table ) const
+        {
+            std::vector< std::vector< std::uint64_t > > offsets;
+            archive& table.m_headings;
+            archive& offsets;
+            for( const auto& rowOffsets : offsets )
+            {
+                ContainerVector< Value > row;
+                for( std::uint64_t uiOffset : rowOffsets )
+                {
+                    row.push_back( child( uiOffset ).load() );
+                }
+                table.m_rows.push_back( std::move( row ) );
+            }
+        }
+
+        template < typename T >
+        void loadElement( BinaryIArchive& archive, T& element ) const
+        {
+            detail::binaryFields( archive, element );
+        }
+
+        const BinaryReport* m_pReport;
+        std::uint64_t       m_uiOffset;
+        std::uint8_t        m_uiType = 0U;
+    };
+
+    explicit BinaryReport( const boost::filesystem::path& filePath )
+        : m_file( filePath )
+    {
+    }
+
+    BinaryReport( const BinaryReport& )            = delete;
+    BinaryReport& operator=( const BinaryReport& ) = delete;
+
+    Element            root() const { return element( m_file.getRootOffset() ); }
+    Container< Value > load() const { return root().load(); }
+
+private:
+    Element element( std::uint64_t uiOffset ) const { return Element( *this, uiOffset ); }
+
+    MappedBinaryReport m_file;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_May_02_binary_report
@@ -0,0 +1,175 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_20_boxed
+#define GUARD_2024_April_20_boxed
+
+#include <boost/serialization/level.hpp>
+#include <boost/serialization/tracking.hpp>
+
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace report
+{
+
+/***
+    Boxed< T >
+
+    An optional value held out of line so that an absent value costs a single pointer.
+    Used for the rarely set url and bookmark of report elements which would otherwise
+    make every Container as large as a URL plus a Value.
+
+    Boxed converts from T and std::optional< T > so the aggregate builder syntax is
+    unchanged and provides the has_value / value / operator* subset of std::optional.
+    Copies are deep.  Archives are those of std::optional< T >.
+*/
+template < typename T >
+class Boxed
+{
+    template < typename U >
+    using EnableIfValue
+        = std::enable_if_t< std::is_constructible_v< T, U&& > && !std::is_same_v< std::decay_t< U >, Boxed >
+                                && !std::is_same_v< std::decay_t< U >, std::nullopt_t >
+                                && !std::is_same_v< std::decay_t< U >, std::optional< T > >,
+                            bool >;
+
+public:
+    using value_type = T;
+
+    Boxed() = default;
+
+    Boxed( std::nullopt_t ) {}
+
+    template < typename U = T, EnableIfValue< U > = true >
+    Boxed( U&& value )
+        : m_pValue( std::make_unique< T >( std::forward< U >( value ) ) )
+    {
+    }
+
+    Boxed( const std::optional< T >& valueOpt )
+        : m_pValue( valueOpt.has_value() ? std::make_unique< T >( valueOpt.value() ) : nullptr )
+    {
+    }
+
+    Boxed( std::optional< T >&& valueOpt )
+        : m_pValue( valueOpt.has_value() ? std::make_unique< T >( std::move( valueOpt.value() ) ) : nullptr )
+    {
+    }
+
+    Boxed( const Boxed& other )
+        : m_pValue( other.m_pValue ? std::make_unique< T >( *other.m_pValue ) : nullptr )
+    {
+    }
+
+    Boxed( Boxed&& other ) noexcept = default;
+
+    Boxed& operator=( const Boxed& other )
+    {
+        if( this != &other )
+        {
+            m_pValue = other.m_pValue ? std::make_unique< T >( *other.m_pValue ) : nullptr;
+        }
+        return *this;
+    }
+
+    Boxed& operator=( Boxed&& other ) noexcept = default;
+
+    inline bool     has_value() const { return m_pValue != nullptr; }
+    inline explicit operator bool() const { return m_pValue != nullptr; }
+
+    inline const T& value() const
+    {
+        if( !m_pValue )
+        {
+            throw std::bad_optional_access();
+        }
+        return *m_pValue;
+    }
+    inline T& value()
+    {
+        if( !m_pValue )
+        {
+            throw std::bad_optional_access();
+        }
+        return *m_pValue;
+    }
+
+    inline const T& operator*() const { return *m_pValue; }
+    inline T&       operator*() { return *m_pValue; }
+    inline const T* operator->() const { return m_pValue.get(); }
+    inline T*       operator->() { return m_pValue.get(); }
+
+    inline void reset() { m_pValue.reset(); }
+
+    template < typename... Args >
+    inline T& emplace( Args&&... args )
+    {
+        m_pValue = std::make_unique< T >( std::forward< Args >( args )... );
+        return *m_pValue;
+    }
+
+    // NOTE: serialised as the std::optional< T > it replaced so that existing archives still load
+    template < class Archive >
+    inline void serialize( Archive& archive, const unsigned int )
+    {
+        std::optional< T > valueOpt;
+        if constexpr( Archive::is_saving::value )
+        {
+            if( m_pValue )
+            {
+                valueOpt = *m_pValue;
+            }
+        }
+        archive& valueOpt;
+        if constexpr( Archive::is_loading::value )
+        {
+            *this = Boxed( std::move( valueOpt ) );
+        }
+    }
+
+private:
+    std::unique_ptr< T > m_pValue;
+};
+
+} // namespace report
+
+// Boxed writes no class information or tracking of its own so its archive matches std::optional< T >
+namespace boost::serialization
+{
+template < typename T >
+struct implementation_level< report::Boxed< T > >
+{
+    typedef mpl::integral_c_tag              tag;
+    typedef mpl::int_< object_serializable > type;
+    BOOST_STATIC_CONSTANT( int, value = implementation_level::type::value );
+};
+
+template < typename T >
+struct tracking_level< report::Boxed< T > >
+{
+    typedef mpl::integral_c_tag      tag;
+    typedef mpl::int_< track_never > type;
+    BOOST_STATIC_CONSTANT( int, value = tracking_level::type::value );
+};
+} // namespace boost::serialization
+
+#endif // GUARD_2024_April_20_boxed
@@ -0,0 +1,274 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_May_09_container_hash
+#define GUARD_2024_May_09_container_hash
+
+#include "report/hash.hpp"
+#include "report/report.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace report
+{
+using ContainerDigests = std::unordered_map< const void*, SHA256::Digest >;
+
+namespace detail
+{
+// feeds length prefixed fields to a SHA256 so that the boundaries between them are unambiguous
+class StructuralHash
+{
+public:
+    StructuralHash& text( std::string_view str )
+    {
+        number( str.size() );
+        m_hash.update( str );
+        return *this;
+    }
+    StructuralHash& number( std::uint64_t uiNumber )
+    {
+        m_hash.update( &uiNumber, sizeof( uiNumber ) );
+        return *this;
+    }
+    StructuralHash& digest( const SHA256::Digest& digest )
+    {
+        m_hash.update( digest.data(), digest.size() );
+        return *this;
+    }
+
+    // values are hashed by their formatted text which is all the renderer uses of them
+    template < typename Value >
+    StructuralHash& value( const Value& value )
+    {
+        return text( formatValue( value, m_strBuffer ) );
+    }
+    template < typename Values >
+    StructuralHash& values( const Values& values )
+    {
+        number( values.size() );
+        for( const auto& value : values )
+        {
+            this->value( value );
+        }
+        return *this;
+    }
+    template < typename Optional, typename Function >
+    StructuralHash& optional( const Optional& valueOpt, Function&& function )
+    {
+        number( valueOpt.has_value() ? 1U : 0U );
+        if( valueOpt.has_value() )
+        {
+            function( valueOpt.value() );
+        }
+        return *this;
+    }
+    template < typename Optional >
+    StructuralHash& url( const Optional& urlOpt )
+    {
+        return optional( urlOpt, [ this ]( const URL& url ) { text( url.buffer() ); } );
+    }
+    template < typename Optional >
+    StructuralHash& bookmark( const Optional& bookmarkOpt )
+    {
+        return optional( bookmarkOpt, [ this ]( const auto& bookmark ) { value( bookmark ); } );
+    }
+
+    SHA256::Digest finish() { return m_hash.digest(); }
+
+private:
+    SHA256      m_hash;
+    std::string m_strBuffer;
+};
+
+// hashes the fields of the container itself taking the digests of its children from childDigest
+template < typename Value, typename ChildDigest >
+inline SHA256::Digest hashElement( const Container< Value >& container, ChildDigest& childDigest )
+{
+    struct Visitor
+    {
+        StructuralHash& hash;
+        ChildDigest&    childDigest;
+
+        void operator()( const Line< Value >& line ) const
+        {
+            hash.text( "line" ).value( line.m_element ).url( line.m_url ).bookmark( line.m_bookmark );
+            hash.text( line.m_colour.str() ).text( line.m_background_colour.str() );
+        }
+        void operator()( const Multiline< Value >& multiline ) const
+        {
+            hash.text( "multiline" ).values( multiline.m_elements );
+            hash.url( multiline.m_url ).bookmark( multiline.m_bookmark );
+            hash.text( multiline.m_colour.str() ).text( multiline.m_background_colour.str() );
+        }
+        void operator()( const Branch< Value >& branch ) const
+        {
+            hash.text( "branch" ).values( branch.m_label ).bookmark( branch.m_bookmark );
+            hash.number( branch.m_elements.size() );
+            for( const Container< Value >& child : branch.m_elements )
+            {
+                hash.digest( childDigest( child ) );
+            }
+        }
+        void operator()( const Table< Value >& table ) const
+        {
+            hash.text( "table" ).values( table.m_headings ).number( table.m_rows.size() );
+            for( const ContainerVector< Value >& row : table.m_rows )
+            {
+                hash.number( row.size() );
+                for( const Container< Value >& cell : row )
+                {
+                    hash.digest( childDigest( cell ) );
+                }
+            }
+        }
+        void operator()( const Plot< Value >& plot ) const
+        {
+            hash.text( "plot" ).values( plot.m_heading ).text( plot.m_style.str() ).number( plot.m_points.size() );
+            for( const auto& point : plot.m_points )
+            {
+                hash.values( point );
+            }
+        }
+        void operator()( const Graph< Value >& graph ) const
+        {
+            hash.text( "graph" ).text( graph.m_rankDirection.str() ).number( graph.m_nodes.size() );
+            for( const auto& node : graph.m_nodes )
+            {
+                hash.number( node.m_rows.size() );
+                for( const auto& row : node.m_rows )
+                {
+                    hash.values( row );
+                }
+                hash.text( node.m_colour.str() ).text( node.m_background_colour.str() );
+                hash.number( static_cast< std::uint64_t >( node.m_border_width ) );
+                hash.url( node.m_url ).bookmark( node.m_bookmark );
+            }
+            hash.number( graph.m_edges.size() );
+            for( const auto& edge : graph.m_edges )
+            {
+                hash.number( edge.m_source ).number( edge.m_target );
+                hash.text( edge.m_colour.str() ).text( edge.m_style.str() );
+                hash.number( edge.m_bIgnoreInLayout ? 1U : 0U );
+                hash.number( static_cast< std::uint64_t >( edge.line_width ) );
+                hash.optional( edge.m_label, [ this ]( const auto& label ) { hash.values( label ); } );
+            }
+            hash.number( graph.m_subgraphs.size() );
+            for( const auto& subgraph : graph.m_subgraphs )
+            {
+                hash.number( subgraph.m_rows.size() );
+                for( const auto& row : subgraph.m_rows )
+                {
+                    hash.values( row );
+                }
+                hash.number( subgraph.m_nodes.size() );
+                for( const auto iNode : subgraph.m_nodes )
+                {
+                    hash.number( iNode );
+                }
+                hash.text( subgraph.m_colour.str() ).url( subgraph.m_url ).bookmark( subgraph.m_bookmark );
+            }
+        }
+    };
+
+    StructuralHash hash;
+    std::visit( Visitor{ hash, childDigest }, container );
+    return hash.finish();
+}
+
+// number of values in the container itself saturating for plots and graphs as in exceedsGrainSize
+template < typename Value >
+inline std::size_t elementSize( const Container< Value >& container )
+{
+    struct Visitor
+    {
+        std::size_t operator()( const Line< Value >& ) const { return 1U; }
+        std::size_t operator()( const Multiline< Value >& multiline ) const { return multiline.m_elements.size(); }
+        std::size_t operator()( const Branch< Value >& branch ) const { return branch.m_label.size(); }
+        std::size_t operator()( const Table< Value >& table ) const { return table.m_headings.size(); }
+        std::size_t operator()( const Plot< Value >& ) const { return std::numeric_limits< std::size_t >::max(); }
+        std::size_t operator()( const Graph< Value >& ) const { return std::numeric_limits< std::size_t >::max(); }
+    };
+    return std::visit( Visitor{}, container );
+}
+
+inline std::size_t saturatingAdd( std::size_t szLeft, std::size_t szRight )
+{
+    return ( szRight > std::numeric_limits< std::size_t >::max() - szLeft ) ? std::numeric_limits< std::size_t >::max()
+                                                                           : szLeft + szRight;
+}
+
+// returns the saturating number of values in the subtree
+template < typename Value >
+inline std::size_t hashSubtrees( const Container< Value >& container, std::size_t szMinSize,
+                                 ContainerDigests& digests, SHA256::Digest& digest )
+{
+    std::size_t szSize      = elementSize( container );
+    auto        childDigest = [ & ]( const Container< Value >& child )
+    {
+        SHA256::Digest digestChild;
+        szSize = saturatingAdd( szSize, hashSubtrees( child, szMinSize, digests, digestChild ) );
+        return digestChild;
+    };
+    digest = hashElement( container, childDigest );
+    if( szSize >= szMinSize )
+    {
+        digests.emplace( &container, digest );
+    }
+    return szSize;
+}
+} // namespace detail
+
+/***
+    hashContainer
+
+    Structural hash of a report tree computed bottom up in the manner of a Merkle tree.  Each
+    element hashes its own fields and the digests of its children so equal subtrees have equal
+    digests wherever they occur and a change alters only the digests on its path to the root.
+    Covers every field that affects the rendered html.
+*/
+template < typename Value >
+inline SHA256::Digest hashContainer( const Container< Value >& container )
+{
+    auto childDigest = []( const Container< Value >& child ) { return hashContainer( child ); };
+    return detail::hashElement( container, childDigest );
+}
+
+/***
+    hashSubtrees
+
+    The hashContainer digests of every subtree holding at least szMinSize values computed in a
+    single bottom up pass and keyed by the address of the subtree.  Lets a render look up the
+    digest of each nested fragment instead of hashing the fragment again at every level.
+*/
+template < typename Value >
+inline ContainerDigests hashSubtrees( const Container< Value >& container, std::size_t szMinSize )
+{
+    ContainerDigests digests;
+    SHA256::Digest   digest;
+    detail::hashSubtrees( container, szMinSize, digests, digest );
+    return digests;
+}
+
+} // namespace report
+
+#endif // GUARD_2024_May_09_container_hash
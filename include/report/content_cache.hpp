@@ -0,0 +1,97 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_28_content_cache
+#define GUARD_2024_March_28_content_cache
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace report
+{
+
+/***
+    ContentCache
+
+    Persistent content addressed cache of generated text.  Keys are hex digests of everything
+    that determines the content so an unchanged graph or plot svg costs a file read instead of
+    running graphviz or gnuplot, and an unchanged html fragment one instead of rendering it.
+    Each entry is stored as <key><extension> in the cache directory, such as .svg or .html, and
+    the least recently used entries are evicted once the total size exceeds the limit.  Recency
+    persists between runs via the file modification time.  Temporary files left behind by
+    stores that were interrupted are removed on opening.
+
+    The cache may be shared by any number of engines and threads.
+*/
+class ContentCache
+{
+public:
+    static constexpr std::uint64_t DEFAULT_MAX_BYTES = 256U * 1024U * 1024U;
+
+    struct Statistics
+    {
+        std::size_t szHits      = 0U;
+        std::size_t szMisses    = 0U;
+        std::size_t szEvictions = 0U;
+    };
+
+    explicit ContentCache( const boost::filesystem::path& directory, std::uint64_t uiMaxBytes = DEFAULT_MAX_BYTES,
+                           const std::string& strExtension = ".svg" );
+
+    ContentCache( const ContentCache& )            = delete;
+    ContentCache& operator=( const ContentCache& ) = delete;
+
+    std::optional< std::string > load( const std::string& strKey );
+    void                         store( const std::string& strKey, const std::string& strContent );
+
+    Statistics                     getStatistics() const;
+    std::uint64_t                  getTotalBytes() const;
+    const boost::filesystem::path& getDirectory() const { return m_directory; }
+
+private:
+    struct Entry
+    {
+        std::string   strKey;
+        std::uint64_t uiSize;
+    };
+    // most recently used first
+    using EntryList = std::list< Entry >;
+
+    boost::filesystem::path entryPath( const std::string& strKey ) const;
+    void                    evict();
+
+    const boost::filesystem::path                          m_directory;
+    const std::uint64_t                                    m_uiMaxBytes;
+    const std::string                                      m_strExtension;
+    mutable std::mutex                                     m_mutex;
+    EntryList                                              m_entries;
+    std::unordered_map< std::string, EntryList::iterator > m_index;
+    std::uint64_t                                          m_uiTotalBytes = 0U;
+    Statistics                                             m_statistics;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_28_content_cache
@@ -0,0 +1,119 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_27_deferred_output
+#define GUARD_2024_March_27_deferred_output
+
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace report
+{
+
+/***
+    DeferredOutput
+
+    Stream buffer that lets parts of the output be produced later.  defer() reserves the
+    current position for a future and the text written afterwards is held back until every
+    future before it has resolved.  The HTMLTemplateEngine uses it to keep generating html
+    while gnuplot and graphviz run, splicing each svg into place once it is ready.
+
+    With a destination the resolved prefix is written through as soon as possible, at each defer()
+    and whenever DRAIN_SIZE bytes have been held back since, and flush() waits for the rest.  Without one everything accumulates until writeTo() moves it into
+    another stream, splicing the pending futures into it when that is also a DeferredOutput.
+
+    Children created for parts of the output rendered elsewhere share the root of their parent
+    so that state kept for one render, such as batched graphs, can be found from any of them.
+*/
+class DeferredOutput : public std::streambuf
+{
+public:
+    using Future = std::shared_future< std::string >;
+
+    static constexpr std::size_t DRAIN_SIZE = 16U * 1024U;
+
+    DeferredOutput() = default;
+    explicit DeferredOutput( std::ostream& os )
+        : m_pDestination( &os )
+    {
+    }
+
+    DeferredOutput( const DeferredOutput& )            = delete;
+    DeferredOutput& operator=( const DeferredOutput& ) = delete;
+
+    // returns the DeferredOutput an ostream writes to if any
+    static DeferredOutput* get( std::ostream& os ) { return dynamic_cast< DeferredOutput* >( os.rdbuf() ); }
+
+    // accumulating DeferredOutput for output that will be written into this one
+    std::unique_ptr< DeferredOutput > createChild() const;
+
+    // the DeferredOutput this one is ultimately written into, which is itself unless a child
+    const DeferredOutput& root() const { return *m_pRoot; }
+
+    // NOTE: exceptions from futures that have already failed are rethrown here
+    void defer( Future future );
+
+    // accumulating only: moves all content to os
+    void writeTo( std::ostream& os );
+
+    // accumulating only: a future for a copy of the content written so far which waits for the
+    // deferred parts when it is read.  The content itself is left in place.
+    Future share() const;
+
+    // destination only: waits for all deferred content and writes it out
+    void flush();
+
+    // throws once more than szLimit bytes of text have been written, counting text still held
+    // back behind pending futures.  Deferred content is not counted as it is only known later.
+    void setLimit( std::size_t szLimit ) { m_szLimit = szLimit; }
+    bool hasOverflowed() const { return m_bOverflowed; }
+
+protected:
+    std::streamsize xsputn( const char* pData, std::streamsize szSize ) override;
+    int_type        overflow( int_type ch ) override;
+
+private:
+    void append( const char* pData, std::size_t szSize );
+    void drain( bool bRethrow );
+
+    // a deferred future followed by the text written after it
+    struct Segment
+    {
+        Future      future;
+        std::string strText;
+    };
+
+    const DeferredOutput* m_pRoot        = this;
+    std::ostream*         m_pDestination = nullptr;
+    std::string           m_strHead;
+    std::deque< Segment > m_segments;
+    std::size_t           m_szHeldBack  = 0U;
+    std::size_t           m_szLimit     = std::numeric_limits< std::size_t >::max();
+    std::size_t           m_szWritten   = 0U;
+    bool                  m_bOverflowed = false;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_27_deferred_output
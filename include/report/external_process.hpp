@@ -0,0 +1,47 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_27_external_process
+#define GUARD_2024_March_27_external_process
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace report
+{
+
+struct ProcessResult
+{
+    int         iExitCode = 0;
+    std::string strOutput;
+    std::string strError;
+};
+
+// Runs strProgram, located on the PATH, with arguments and strInput written to its standard input
+// capturing its output so that scripts and data need not be written to files.  The current working
+// directory of the calling process is never changed so any number of processes can run concurrently.
+// Throws if the program cannot be found or if it has not completed within timeout in which case it
+// is terminated.  A zero timeout waits forever.
+ProcessResult runExternalProcess( const std::string& strProgram, const std::vector< std::string >& arguments,
+                                  const std::string& strInput, std::chrono::milliseconds timeout );
+
+} // namespace report
+
+#endif // GUARD_2024_March_27_external_process
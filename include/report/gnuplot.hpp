@@ -0,0 +1,66 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_29_gnuplot
+#define GUARD_2024_March_29_gnuplot
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace report
+{
+
+/***
+    GNUPlot
+
+    A long lived gnuplot process fed scripts over a pipe.  Avoids the startup cost of one
+    gnuplot process per plot.  The process starts on first use and is restarted after a
+    failure.  Each script writes its svg to stdout and is followed by a marker printed to
+    stdout so that the svg and its completion are read from one stream.  Anything gnuplot
+    reports on stderr meanwhile is an error.
+
+    run may be called from multiple threads.  Scripts are executed one at a time.
+*/
+class GNUPlot
+{
+public:
+    GNUPlot();
+    ~GNUPlot();
+
+    GNUPlot( const GNUPlot& )            = delete;
+    GNUPlot& operator=( const GNUPlot& ) = delete;
+
+    // runs strScript after resetting the session and returns the svg it wrote.  Throws if gnuplot
+    // reports any error or does not complete within timeout in which case it is terminated.
+    // Zero waits forever.
+    std::string run( const std::string& strScript, std::chrono::milliseconds timeout );
+
+private:
+    struct Process;
+
+    std::mutex                 m_mutex;
+    std::unique_ptr< Process > m_pProcess;
+    std::size_t                m_szScripts = 0U;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_29_gnuplot
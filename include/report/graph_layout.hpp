@@ -0,0 +1,41 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_09_graph_layout
+#define GUARD_2024_April_09_graph_layout
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+namespace report
+{
+
+// Appends a standalone svg for the graph data given to the graph template to strOutput using an
+// in process layered layout.  Nodes are ranked along the rank direction by longest path, ignoring
+// edges that are not constraints, with cycles broken by reversing back edges.  The order within each
+// rank minimises edge crossings by barycenter sweeps keeping the nodes of each subgraph together and
+// positions are then straightened towards each node's neighbours.  Requires the plain "text" cells,
+// "source" and "target" edge indices and subgraph "node_indices" that the renderer adds for native
+// layout.  Bookmarks become the id of the first text of their node as in the graphviz output.
+void renderSVGGraph( const nlohmann::json& data, std::string& strOutput );
+
+} // namespace report
+
+#endif // GUARD_2024_April_09_graph_layout
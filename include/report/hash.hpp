@@ -0,0 +1,68 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_28_hash
+#define GUARD_2024_March_28_hash
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace report
+{
+
+/***
+    SHA256
+
+    Incremental SHA-256 used for content addressed caching of generated output.
+*/
+class SHA256
+{
+public:
+    using Digest = std::array< std::uint8_t, 32 >;
+
+    SHA256();
+
+    SHA256& update( const void* pData, std::size_t szSize );
+    SHA256& update( std::string_view str ) { return update( str.data(), str.size() ); }
+
+    // completes the hash.  The object must not be updated afterwards.
+    Digest      digest();
+    std::string hexDigest() { return toHex( digest() ); }
+
+    static std::string toHex( const Digest& digest );
+
+private:
+    void compress( const std::uint8_t* pBlock );
+
+    std::array< std::uint32_t, 8 > m_state;
+    std::array< std::uint8_t, 64 > m_block;
+    std::size_t                    m_szBlock = 0U;
+    std::uint64_t                  m_uiTotal = 0U;
+};
+
+inline std::string sha256( std::string_view str )
+{
+    return SHA256().update( str ).hexDigest();
+}
+
+} // namespace report
+
+#endif // GUARD_2024_March_28_hash
@@ -0,0 +1,67 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_May_09_html_assets
+#define GUARD_2024_May_09_html_assets
+
+#include <nlohmann/json.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace report
+{
+
+/***
+    HTMLAssets
+
+    Files written beside a report and referred to from its pages instead of being inlined.
+    Each is named by the hash of its content so browsers can cache it indefinitely and reports
+    sharing the folder share their identical svgs, style and script.
+*/
+class HTMLAssets
+{
+public:
+    // strURL is the url of directory relative to the report pages
+    HTMLAssets( const boost::filesystem::path& directory, const std::string& strURL );
+
+    // writes strContent unless already present returning its url
+    std::string store( std::string_view strContent, std::string_view strExtension ) const;
+
+    // html for an svg stored as an asset which the report script fetches once it scrolls into
+    // view.  The placeholder keeps the svg's size and lists the bookmarks in the json array
+    // bookmarks so navigating to one of them loads it.
+    std::string svgPlaceholder( std::string_view strSVG, const nlohmann::json& bookmarks ) const;
+
+    // true when every svg placeholder in strHTML refers to a file present in this folder
+    bool hasPlaceholderFiles( std::string_view strHTML ) const;
+
+    const boost::filesystem::path& getDirectory() const { return m_directory; }
+    const std::string&             getURL() const { return m_strURL; }
+
+private:
+    boost::filesystem::path m_directory;
+    std::string             m_strURL;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_May_09_html_assets
@@ -0,0 +1,45 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_22_html_escape
+#define GUARD_2024_March_22_html_escape
+
+#include <string>
+#include <string_view>
+
+namespace report
+{
+
+// Appends the html escaped form of str to strOutput in a single pass.
+// The characters & " ' < > are replaced by their entities and the record separator
+// by &#30;.  strOutput is not cleared so callers can reuse one buffer or build up a
+// larger string.
+// Uses AVX2 or SSE2 to scan for the special characters when compiled for them.
+void escapeHTML( std::string_view str, std::string& strOutput );
+
+inline std::string escapeHTML( std::string_view str )
+{
+    std::string strOutput;
+    escapeHTML( str, strOutput );
+    return strOutput;
+}
+
+} // namespace report
+
+#endif // GUARD_2024_March_22_html_escape
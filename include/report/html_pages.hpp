@@ -0,0 +1,112 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_May_02_html_pages
+#define GUARD_2024_May_02_html_pages
+
+#include "report/html_template_engine.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <boost/filesystem/path.hpp>
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace report
+{
+
+/***
+    PageBuffer
+
+    Collects one rendered piece of a paged report.  Writing past the limit throws so that the
+    render of an oversized branch is abandoned early and the branch split.  The renderer wraps
+    the exception on the way out so hasOverflowed tells it apart from a failed render.
+*/
+class PageBuffer : public std::streambuf
+{
+public:
+    explicit PageBuffer( std::size_t szLimit )
+        : m_szLimit( szLimit )
+    {
+    }
+
+    bool        hasOverflowed() const { return m_bOverflowed; }
+    std::string take() { return std::move( m_str ); }
+
+protected:
+    std::streamsize xsputn( const char* pData, std::streamsize szSize ) override;
+    int_type        overflow( int_type ch ) override;
+
+private:
+    const std::size_t m_szLimit;
+    std::string       m_str;
+    bool              m_bOverflowed = false;
+};
+
+/***
+    HTMLPageWriter
+
+    Writes the files of a report split into several pages.  Each page is written when the next
+    one is added so that it can link to it and no more than one page is held at a time.  finish
+    writes the last page, the index page and the map of bookmarks to the pages containing them
+    which the report javascript loads to follow a fragment that is not on the current page.
+*/
+class HTMLPageWriter
+{
+public:
+    static constexpr std::size_t DEFAULT_PAGE_SIZE = 4U * 1024U * 1024U;
+    static constexpr const char* INDEX_PAGE        = "index.html";
+    static constexpr const char* BOOKMARK_MAP      = "bookmarks.js";
+
+    HTMLPageWriter( const HTMLTemplateEngine& engine, const boost::filesystem::path& directory );
+
+    static std::string pageName( std::size_t szPage );
+
+    // index of the page that added bookmarks belong to
+    std::size_t currentPage() const { return m_titles.size(); }
+
+    // the first page to contain a bookmark is where it is navigated to
+    void addBookmark( const std::string& strBookmark ) { m_bookmarks.insert( { strBookmark, currentPage() } ); }
+
+    void addPage( const std::string& strTitle, std::string strBody );
+
+    // returns the index page followed by the pages and the bookmark map
+    std::vector< boost::filesystem::path > finish( const std::string& strTitle );
+
+private:
+    nlohmann::json pageData( std::string strBody ) const;
+    void           writePage( const std::string& strName, const nlohmann::json& data );
+    void           writePendingPage( bool bHasNext );
+
+    const HTMLTemplateEngine&              m_engine;
+    boost::filesystem::path                m_directory;
+    std::vector< std::string >             m_titles;
+    std::optional< std::string >           m_pendingBodyOpt;
+    std::map< std::string, std::size_t >   m_bookmarks;
+    std::vector< boost::filesystem::path > m_files;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_May_02_html_pages
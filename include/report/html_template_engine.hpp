@@ -21,11 +21,24 @@
 #ifndef GUARD_2024_March_11_html_template_engine
 #define GUARD_2024_March_11_html_template_engine
 
+#include "report/content_cache.hpp"
+#include "report/gnuplot.hpp"
+#include "report/hash.hpp"
+#include "report/svg_cache.hpp"
+#include "report/template_slots.hpp"
+#include "report/thread_pool.hpp"
+
 #include <nlohmann/json.hpp>
 
 #include <boost/filesystem/path.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <array>
 #include <string>
 #include <map>
@@ -57,14 +70,26 @@ using json = basic_json<>;
 namespace report
 {
 
+class DeferredOutput;
+class HTMLAssets;
+
+// the set functions configure the engine up front after which render only reads it.  Templates
+// are parsed once and shared, and any state needed during a render is kept per renderHTML call,
+// so a single engine can render any number of reports concurrently.
 class HTMLTemplateEngine
 {
-    using EnvironmentPtr = std::unique_ptr< inja::Environment >;
-    using TemplatePtr    = std::unique_ptr< inja::Template >;
+    using EnvironmentPtr   = std::unique_ptr< inja::Environment >;
+    using TemplatePtr      = std::unique_ptr< inja::Template >;
+    using CompiledTemplate = void ( * )( const nlohmann::json&, std::ostream&, TemplateSlots* );
 
     EnvironmentPtr m_pEnvironment;
 
 public:
+    static constexpr std::size_t DEFAULT_GRAIN_SIZE       = 256U;
+    static constexpr std::size_t DEFAULT_MAX_NATIVE_NODES = 200U;
+    static constexpr std::size_t DEFAULT_FRAGMENT_SIZE    = 1024U;
+    static constexpr std::size_t NEVER_COLLAPSE           = std::numeric_limits< std::size_t >::max();
+
     enum TemplateType
     {
         eReport,
@@ -73,25 +98,210 @@ public:
         eTable,
         ePlot,
         eGraph,
+        eStyle,  // the css of the report page
+        eScript, // the javascript of the report page
         TOTAL_TEMPLATE_TYPES
     };
 
+    enum PlotBackend
+    {
+        eGNUPlotProcess,   // one gnuplot process per plot fed over its stdin
+        eGNUPlotCoProcess, // a single gnuplot process per engine fed over a pipe
+        eNativePlot,       // in process svg generation which ignores the plot template
+        TOTAL_PLOT_BACKENDS
+    };
+
+    enum GraphBackend
+    {
+        eGraphviz,    // dot run on the graph template, linked in process when built with REPORT_WITH_LIBGVC
+        eNativeGraph, // in process layered layout for graphs up to a size limit which ignores the graph template
+        TOTAL_GRAPH_BACKENDS
+    };
+
 private:
     std::array< std::string, TOTAL_TEMPLATE_TYPES > m_templateNames;
-    boost::filesystem::path                         m_tempFolder;
-    bool                                            m_bClearTempFiles;
-    std::array< TemplatePtr, TOTAL_TEMPLATE_TYPES > m_templates;
+    std::string                                     m_strTemplateHash = "default";
+    bool                                            m_bStreaming      = true;
+    ThreadPool*                                     m_pThreadPool = nullptr;
+    std::size_t                                     m_szGrainSize = DEFAULT_GRAIN_SIZE;
+    std::chrono::milliseconds                       m_processTimeout{ 0 };
+    std::unique_ptr< ThreadPool >                   m_pProcessPool;
+    std::unique_ptr< ThreadPool::TaskGroup >        m_pProcessTasks;
+    ContentCache*                                   m_pSVGCache = nullptr;
+    bool                                            m_bBatchGraphs = false;
+    PlotBackend                                     m_plotBackend  = eGNUPlotProcess;
+    std::unique_ptr< GNUPlot >                      m_pGNUPlot;
+    GraphBackend                                    m_graphBackend     = eGraphviz;
+    std::size_t                                     m_szMaxNativeNodes = DEFAULT_MAX_NATIVE_NODES;
+    ContentCache*                                   m_pFragmentCache   = nullptr;
+    std::size_t                                     m_szFragmentSize   = DEFAULT_FRAGMENT_SIZE;
+    const HTMLAssets*                               m_pAssets          = nullptr;
+    std::size_t                                     m_szCollapseDepth    = NEVER_COLLAPSE;
+    std::size_t                                     m_szCollapseChildren = NEVER_COLLAPSE;
+
+    // maps an svg to the html written in its place.  When empty the svg itself is written.
+    using SVGFilter = std::function< std::string( std::string ) >;
 
-    void renderTemplate( const nlohmann::json& data, TemplateType templateType, std::ostream& os );
-    void renderPlot( const nlohmann::json& data, std::ostream& os );
-    void renderGraph( const nlohmann::json& data, std::ostream& os );
+    struct BatchedGraph
+    {
+        std::string                 strDot;
+        std::string                 strCacheKey;
+        SVGFilter                   filter;
+        std::promise< std::string > promise;
+    };
+    using GraphBatch = std::vector< BatchedGraph >;
+
+    // graphs batched by each render in progress keyed by the root of its DeferredOutput
+    mutable std::mutex                                    m_batchMutex;
+    mutable std::map< const DeferredOutput*, GraphBatch > m_graphBatches;
+
+    // fragments rendered by each render in progress which are stored once its output is complete
+    using PendingFragments = std::vector< std::pair< std::string, std::shared_future< std::string > > >;
+    mutable std::mutex                                          m_fragmentMutex;
+    mutable std::map< const DeferredOutput*, PendingFragments > m_pendingFragments;
+
+    std::array< TemplatePtr, TOTAL_TEMPLATE_TYPES >      m_templates;
+    std::array< CompiledTemplate, TOTAL_TEMPLATE_TYPES > m_compiledTemplates{};
+
+    void renderTemplate( const nlohmann::json& data, TemplateType templateType, std::ostream& os,
+                         TemplateSlots* pSlots ) const;
+    void renderPlot( const nlohmann::json& data, std::ostream& os, const SVGFilter& filter ) const;
+    void renderGraph( const nlohmann::json& data, std::ostream& os, const SVGFilter& filter ) const;
+    void renderAsset( TemplateType templateType, const nlohmann::json& data, std::ostream& os ) const;
+
+    // external processes read their script and data from stdin and write the svg to stdout
+    std::string runGNUPlot( const std::string& strData, const std::string& strScript ) const;
+    std::string runGNUPlotCoProcess( const std::string& strData, const std::string& strScript ) const;
+    std::string runGraphviz( const std::string& strDot ) const;
+    void        runGraphvizBatch( GraphBatch& batch ) const;
+    bool loadCachedSVG( const std::string& strCacheKey, std::ostream& os, const SVGFilter& filter ) const;
+    void dispatch( const std::string& strCacheKey, std::function< std::string() > job, std::ostream& os,
+                   const SVGFilter& filter ) const;
 
 public:
-    HTMLTemplateEngine( bool bClearTempFiles );
+    // default templates use the render functions generated from src/report/templates at build time
+    // unless bCompiledTemplates is false in which case they are interpreted with inja.  Interpreted
+    // default templates are parsed once per process when first rendered and shared by all engines.
+    // NOTE: bClearTempFiles is unused as plots and graphs no longer write temporary files
+    HTMLTemplateEngine( bool bClearTempFiles, bool bCompiledTemplates = true );
+
+    // custom templates are always interpreted with inja
     HTMLTemplateEngine( const boost::filesystem::path& templateDir, bool bClearTempFiles );
     ~HTMLTemplateEngine();
 
-    void render( TemplateType templateType, const nlohmann::json& data, std::ostream& os );
+    // process wide engine with the default settings used by renderHTML when not given an engine.
+    // Created on first use and never modified so that every render can share it.
+    static const HTMLTemplateEngine& getDefault();
+
+    // when streaming child containers are passed to templates as TemplateSlots placeholders
+    // and rendered directly into the parent output instead of via intermediate strings
+    void setStreaming( bool bStreaming ) { m_bStreaming = bStreaming; }
+    bool isStreaming() const { return m_bStreaming; }
+
+    // when a thread pool is set and streaming is enabled the children of Branches and Tables
+    // are rendered in parallel and joined in order.  Subtrees with fewer than szGrainSize
+    // values are rendered inline by their parent.  Output is identical to the serial path.
+    void setThreadPool( ThreadPool* pThreadPool, std::size_t szGrainSize = DEFAULT_GRAIN_SIZE )
+    {
+        m_pThreadPool = pThreadPool;
+        m_szGrainSize = szGrainSize;
+    }
+    ThreadPool* getThreadPool() const { return m_pThreadPool; }
+    std::size_t getGrainSize() const { return m_szGrainSize; }
+
+    // when szMaxProcesses is non-zero gnuplot and graphviz run asynchronously, at most
+    // szMaxProcesses at a time, while html generation continues.  Each svg is spliced
+    // into its place in the output once ready via DeferredOutput.  Requires streaming.
+    void setMaxProcesses( std::size_t szMaxProcesses );
+    bool isAsync() const { return m_pProcessPool != nullptr; }
+
+    // gnuplot and graphviz are terminated and rendering fails if they take longer than
+    // timeout.  Zero disables the timeout.  Does not apply to graphviz linked in process.
+    void setProcessTimeout( std::chrono::milliseconds timeout ) { m_processTimeout = timeout; }
+
+    // the plot template is given the name of the gnuplot data block holding the points as "data"
+    // and writes its svg to stdout.  Templates written for files should plot {{ data }} instead of
+    // 'plot.dat' and leave the output unset.  "output" is given as empty for those that already use
+    // it and rendering fails if the template sets an output file.
+    void        setPlotBackend( PlotBackend plotBackend );
+    PlotBackend getPlotBackend() const { return m_plotBackend; }
+
+    // with eNativeGraph graphs with at most szMaxNativeNodes nodes are laid out in process and
+    // larger graphs still use graphviz
+    void setGraphBackend( GraphBackend graphBackend, std::size_t szMaxNativeNodes = DEFAULT_MAX_NATIVE_NODES )
+    {
+        m_graphBackend     = graphBackend;
+        m_szMaxNativeNodes = szMaxNativeNodes;
+    }
+    GraphBackend getGraphBackend() const { return m_graphBackend; }
+    bool         isNativeGraph( std::size_t szNodes ) const
+    {
+        return ( m_graphBackend == eNativeGraph ) && ( szNodes <= m_szMaxNativeNodes );
+    }
+
+    // when set plots and graphs are looked up in the cache by a hash of their script and data
+    // before running gnuplot or graphviz and newly generated svgs are added to it
+    void          setSVGCache( ContentCache* pSVGCache ) { m_pSVGCache = pSVGCache; }
+    ContentCache* getSVGCache() const { return m_pSVGCache; }
+
+    // when batching graphs are collected during rendering and laid out by a single graphviz
+    // process in flushGraphBatch which renderHTML calls once the rest of the report is done.
+    // Each graph's svg is split back out and spliced into place.  Requires streaming.
+    // Graphs are batched per output so concurrent renders each flush only their own.
+    void setBatchGraphs( bool bBatchGraphs ) { m_bBatchGraphs = bBatchGraphs; }
+    bool isBatchingGraphs() const { return m_bBatchGraphs; }
+    void flushGraphBatch( const DeferredOutput& output ) const;
+
+    // drops the graphs batched for output when its render fails
+    void discardGraphBatch( const DeferredOutput& output ) const;
+
+    // when set every subtree of at least szFragmentSize values, and every plot and graph, is
+    // looked up in the cache by its structural hash and the engine settings that affect its
+    // html.  Only subtrees that are not found are rendered, after which they are added.
+    void setFragmentCache( ContentCache* pFragmentCache, std::size_t szFragmentSize = DEFAULT_FRAGMENT_SIZE )
+    {
+        m_pFragmentCache = pFragmentCache;
+        m_szFragmentSize = szFragmentSize;
+    }
+    ContentCache* getFragmentCache() const { return m_pFragmentCache; }
+    std::size_t   getFragmentSize() const { return m_szFragmentSize; }
+    std::string   fragmentCacheKey( const SHA256::Digest& digest, std::size_t szDepth ) const;
+
+    // a fragment rendered into output which may still contain deferred plots and graphs is
+    // stored by storeFragments once the render has flushed output
+    void deferFragment( const DeferredOutput& output, const std::string& strCacheKey,
+                        std::shared_future< std::string > fragment ) const;
+    void storeFragments( const DeferredOutput& output ) const;
+    void discardFragments( const DeferredOutput& output ) const;
+
+    // when set each plot and graph svg is written to a content addressed file and the page
+    // refers to it with a placeholder which the report script fetches as it scrolls into view.
+    // The page style and script are also written as files so are loaded once for all pages.
+    void              setAssets( const HTMLAssets* pAssets ) { m_pAssets = pAssets; }
+    const HTMLAssets* getAssets() const { return m_pAssets; }
+
+    // adds the style and script of the report page, or their urls when they are assets, to data
+    void addPageAssets( nlohmann::json& data ) const;
+
+    // Branches nested szDepth or more below the root, or with more than szMaxChildren elements, are
+    // rendered collapsed.  Their elements are held in an inert template which the report script
+    // only adds to the page when the branch is expanded or a bookmark within it is navigated to.
+    void setCollapseBranches( std::size_t szDepth, std::size_t szMaxChildren = NEVER_COLLAPSE )
+    {
+        m_szCollapseDepth    = szDepth;
+        m_szCollapseChildren = szMaxChildren;
+    }
+    bool isCollapsed( std::size_t szDepth, std::size_t szChildren ) const
+    {
+        return ( szDepth >= m_szCollapseDepth ) || ( szChildren > m_szCollapseChildren );
+    }
+
+    // true when plot or graph output may be deferred in which case the report must be
+    // rendered into a DeferredOutput
+    bool isDeferred() const { return isAsync() || m_bBatchGraphs; }
+
+    void render( TemplateType templateType, const nlohmann::json& data, std::ostream& os,
+                 TemplateSlots* pSlots = nullptr ) const;
 };
 } // namespace report
 
@@ -0,0 +1,152 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_24_interned_string
+#define GUARD_2024_April_24_interned_string
+
+#include <deque>
+#include <functional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace report
+{
+
+class StringPool;
+
+/***
+    InternedString
+
+    Handle to a string held once in a StringPool together with its html escaped form.
+    Add InternedString as an alternative of a report Value for the headings, names and
+    labels that repeat throughout a report.  Every copy shares the pooled storage and the
+    renderer writes the cached escaped text instead of escaping the string again.
+
+    InternedString converts to std::string_view so it formats like any other string.
+    Constructing from text interns it in the process wide default pool.
+*/
+class InternedString
+{
+    friend class StringPool;
+
+public:
+    struct Entry
+    {
+        std::string strValue;
+        std::string strEscaped;
+    };
+
+    InternedString() = default;
+    InternedString( std::string_view str );
+    InternedString( const char* psz )
+        : InternedString( std::string_view( psz ) )
+    {
+    }
+    InternedString( const std::string& str )
+        : InternedString( std::string_view( str ) )
+    {
+    }
+
+    inline std::string_view str() const
+    {
+        return m_pEntry ? std::string_view( m_pEntry->strValue ) : std::string_view{};
+    }
+    inline std::string_view escaped() const
+    {
+        return m_pEntry ? std::string_view( m_pEntry->strEscaped ) : std::string_view{};
+    }
+    inline operator std::string_view() const { return str(); }
+
+    // equal strings from the same pool share an entry so most comparisons are a pointer compare
+    inline bool operator==( const InternedString& other ) const
+    {
+        return ( m_pEntry == other.m_pEntry ) || ( str() == other.str() );
+    }
+    inline bool operator!=( const InternedString& other ) const { return !( *this == other ); }
+    inline bool operator<( const InternedString& other ) const { return str() < other.str(); }
+
+    template < class Archive >
+    inline void serialize( Archive& archive, const unsigned int )
+    {
+        std::string strValue( str() );
+        archive&    strValue;
+        if constexpr( Archive::is_loading::value )
+        {
+            *this = InternedString( strValue );
+        }
+    }
+
+private:
+    explicit InternedString( const Entry* pEntry )
+        : m_pEntry( pEntry )
+    {
+    }
+
+    const Entry* m_pEntry = nullptr;
+};
+
+inline std::ostream& operator<<( std::ostream& os, const InternedString& str )
+{
+    return os << str.str();
+}
+
+/***
+    StringPool
+
+    Owns the entries of interned strings which remain valid for the lifetime of the pool.
+    Strings are never removed so the default pool suits the bounded vocabulary of headings
+    and names in reports rather than arbitrary cell text.
+
+    intern may be called concurrently from any number of threads.
+*/
+class StringPool
+{
+public:
+    StringPool() = default;
+
+    StringPool( const StringPool& )            = delete;
+    StringPool& operator=( const StringPool& ) = delete;
+
+    static StringPool& getDefault();
+
+    InternedString intern( std::string_view str );
+
+    std::size_t size() const;
+
+private:
+    mutable std::shared_mutex                                             m_mutex;
+    std::deque< InternedString::Entry >                                   m_entries;
+    std::unordered_map< std::string_view, const InternedString::Entry* > m_index;
+};
+
+} // namespace report
+
+template <>
+struct std::hash< report::InternedString >
+{
+    std::size_t operator()( const report::InternedString& str ) const noexcept
+    {
+        return std::hash< std::string_view >()( str.str() );
+    }
+};
+
+#endif // GUARD_2024_April_24_interned_string
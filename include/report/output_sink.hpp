@@ -0,0 +1,208 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_15_output_sink
+#define GUARD_2024_April_15_output_sink
+
+#include <boost/filesystem/path.hpp>
+
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <cstdio>
+#endif
+
+#ifdef REPORT_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace report
+{
+
+/***
+    OutputSink
+
+    Destination for rendered output.  Output is handed over as a list of buffers which the
+    sink writes in order with a single gather write where it can, so that buffered chunks
+    and large strings such as svgs are never copied into one contiguous block first.
+*/
+class OutputSink
+{
+public:
+    using Buffer = std::string_view;
+
+    virtual ~OutputSink() = default;
+
+    // writes all of the buffers in order or throws
+    virtual void write( const Buffer* pBuffers, std::size_t szCount ) = 0;
+
+    // called once after the last write
+    virtual void close() {}
+};
+
+/***
+    OutputStream
+
+    std::ostream for the renderer that writes to an OutputSink.  Writes are gathered in a chain
+    of fixed size chunks which is passed to the sink whenever it is full and when flushed.
+    Writes of at least a whole chunk bypass the chunks and are passed on in place.
+*/
+class OutputStream : public std::ostream
+{
+public:
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 64U * 1024U;
+    static constexpr std::size_t DEFAULT_MAX_CHUNKS = 16U;
+
+    explicit OutputStream( OutputSink& sink, std::size_t szChunkSize = DEFAULT_CHUNK_SIZE,
+                           std::size_t szMaxChunks = DEFAULT_MAX_CHUNKS );
+    ~OutputStream();
+
+    OutputStream( const OutputStream& )            = delete;
+    OutputStream& operator=( const OutputStream& ) = delete;
+
+private:
+    class ChunkBuffer : public std::streambuf
+    {
+    public:
+        ChunkBuffer( OutputSink& sink, std::size_t szChunkSize, std::size_t szMaxChunks );
+
+        // writes out the filled chunks followed by an optional buffer in place
+        void flushChunks( std::string_view strTrailing = {} );
+
+    protected:
+        std::streamsize xsputn( const char* pData, std::streamsize szSize ) override;
+        int_type        overflow( int_type ch ) override;
+        int             sync() override;
+
+    private:
+        void nextChunk();
+
+        OutputSink&                              m_sink;
+        const std::size_t                        m_szChunkSize;
+        std::vector< std::unique_ptr< char[] > > m_chunks;
+        std::size_t                              m_szCurrent = 0U;
+    };
+
+    ChunkBuffer m_buffer;
+};
+
+/***
+    StreamSink
+
+    OutputSink that writes to an existing std::ostream.
+*/
+class StreamSink : public OutputSink
+{
+public:
+    explicit StreamSink( std::ostream& os )
+        : m_os( os )
+    {
+    }
+
+    void write( const Buffer* pBuffers, std::size_t szCount ) override;
+    void close() override;
+
+private:
+    std::ostream& m_os;
+};
+
+/***
+    FileSink
+
+    OutputSink that creates or truncates a file and writes to it with writev.
+*/
+class FileSink : public OutputSink
+{
+public:
+    explicit FileSink( const boost::filesystem::path& filePath );
+    ~FileSink();
+
+    FileSink( const FileSink& )            = delete;
+    FileSink& operator=( const FileSink& ) = delete;
+
+    void write( const Buffer* pBuffers, std::size_t szCount ) override;
+    void close() override;
+
+private:
+    boost::filesystem::path m_filePath;
+#ifdef _WIN32
+    std::FILE* m_pFile = nullptr;
+#else
+    int m_iFile = -1;
+#endif
+};
+
+#ifndef _WIN32
+/***
+    SocketSink
+
+    OutputSink that sends to a connected socket which it does not own.  A closed connection
+    is reported by throwing rather than raising SIGPIPE.
+*/
+class SocketSink : public OutputSink
+{
+public:
+    explicit SocketSink( int iSocket )
+        : m_iSocket( iSocket )
+    {
+    }
+
+    void write( const Buffer* pBuffers, std::size_t szCount ) override;
+
+private:
+    int m_iSocket;
+};
+#endif
+
+#ifdef REPORT_WITH_ZLIB
+/***
+    GZipSink
+
+    OutputSink that gzip compresses everything written to it into another OutputSink.  close()
+    completes the gzip stream and closes the target.
+*/
+class GZipSink : public OutputSink
+{
+public:
+    explicit GZipSink( OutputSink& target, int iLevel = Z_DEFAULT_COMPRESSION );
+    ~GZipSink();
+
+    GZipSink( const GZipSink& )            = delete;
+    GZipSink& operator=( const GZipSink& ) = delete;
+
+    void write( const Buffer* pBuffers, std::size_t szCount ) override;
+    void close() override;
+
+private:
+    void compress( Buffer buffer, int iFlush );
+
+    OutputSink&               m_target;
+    z_stream                  m_stream{};
+    std::unique_ptr< char[] > m_pOutput;
+    bool                      m_bClosed = false;
+};
+#endif
+
+} // namespace report
+
+#endif // GUARD_2024_April_15_output_sink
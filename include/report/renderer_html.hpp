@@ -23,8 +23,12 @@
 
 #include "report.hpp"
 #include "html_template_engine.hpp"
+#include "html_assets.hpp"
+#include "html_pages.hpp"
+#include "output_sink.hpp"
 
 #include <ostream>
+#include <vector>
 
 namespace report
 {
@@ -43,6 +47,26 @@ void renderHTML( const Container< Value >& report, std::ostream& os, HTMLTemplat
 template< typename Value, typename Linker >
 void renderHTML( const Container< Value >& report, std::ostream& os, Linker& linker, HTMLTemplateEngine& engine );
 
+// renders to an OutputSink which is closed once the report is complete
+template< typename Value >
+void renderHTML( const Container< Value >& report, OutputSink& sink );
+
+template< typename Value >
+void renderHTML( const Container< Value >& report, OutputSink& sink, HTMLTemplateEngine& engine );
+
+// renders to an index page and pages of about szPageSize bytes split at Branch boundaries
+// in directory returning the files written.  Bookmarks resolve across the pages.
+template< typename Value >
+std::vector< boost::filesystem::path > renderHTMLPages( const Container< Value >& report,
+                                                        const boost::filesystem::path& directory,
+                                                        std::size_t szPageSize = HTMLPageWriter::DEFAULT_PAGE_SIZE );
+
+template< typename Value >
+std::vector< boost::filesystem::path > renderHTMLPages( const Container< Value >& report,
+                                                        const boost::filesystem::path& directory,
+                                                        HTMLTemplateEngine& engine,
+                                                        std::size_t szPageSize = HTMLPageWriter::DEFAULT_PAGE_SIZE );
+
 } // namespace report
 
 #include "renderer_html.tpp"
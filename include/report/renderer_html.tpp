@@ -21,6 +21,13 @@
 #ifndef GUARD_2024_March_08_renderer_html
 #define GUARD_2024_March_08_renderer_html
 
+#include "report/container_hash.hpp"
+#include "report/deferred_output.hpp"
+#include "report/html_escape.hpp"
+#include "report/html_pages.hpp"
+#include "report/interned_string.hpp"
+#include "report/output_sink.hpp"
+
 #include "common/process.hpp"
 #include "common/file.hpp"
 #include "common/string.hpp"
@@ -32,7 +39,11 @@
 #include <boost/algorithm/string.hpp>
 
 #include <algorithm>
+#include <limits>
+#include <optional>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace report
 {
@@ -40,22 +51,11 @@ namespace report
 namespace detail
 {
 
-inline std::string escapeHTML( std::string data )
-{
-    using boost::algorithm::replace_all;
-    replace_all( data, "&", "&amp;" );
-    replace_all( data, "\"", "&quot;" );
-    replace_all( data, "\'", "&apos;" );
-    replace_all( data, "<", "&lt;" );
-    replace_all( data, ">", "&gt;" );
-    return data;
-}
-
 inline std::string javascriptHREF( const URL& url )
 {
-    std::ostringstream os;
-
-    os << "javascript:navigateTo( &quot;" << url.encoded_path() << "&quot;,";
+    std::string str( "javascript:navigateTo( &quot;" );
+    str.append( url.encoded_path() );
+    str.append( "&quot;," );
 
     bool bHasReportType = false;
     {
@@ -73,32 +73,59 @@ inline std::string javascriptHREF( const URL& url )
             // remove the report type
             URL temp = url;
             temp.params().erase( "report" );
-            os << " &quot;" << temp.encoded_params() << "&quot; ,";
+            str.append( " &quot;" );
+            str.append( temp.encoded_params() );
+            str.append( "&quot; ," );
         }
         else
         {
-            os << " &quot;" << url.encoded_params() << "&quot; ,";
+            str.append( " &quot;" );
+            str.append( url.encoded_params() );
+            str.append( "&quot; ," );
         }
     }
     else
     {
-        os << " &quot;&quot; ,";
+        str.append( " &quot;&quot; ," );
     }
 
     if( url.has_fragment() )
     {
-        os << " &quot;" << url.encoded_fragment() << "&quot; )";
+        str.append( " &quot;" );
+        str.append( url.encoded_fragment() );
+        str.append( "&quot; )" );
     }
     else
     {
-        os << " &quot;&quot; )";
+        str.append( " &quot;&quot; )" );
     }
 
-    return os.str();
+    return str;
 }
 
+// Appends the escaped text of value to str.  Interned strings carry their escaped form so
+// only other values are formatted into strBuffer and escaped.
 template < typename Value >
-inline void valueToJSON( HTMLTemplateEngine&, const Value& value, nlohmann::json& data )
+inline void escapeValue( const Value& value, std::string& strBuffer, std::string& str )
+{
+    std::visit(
+        [ & ]( const auto& arg )
+        {
+            using T = std::decay_t< decltype( arg ) >;
+            if constexpr( std::is_same_v< T, InternedString > )
+            {
+                str.append( arg.escaped() );
+            }
+            else
+            {
+                escapeHTML( ValueFormatter< T >::format( arg, strBuffer ), str );
+            }
+        },
+        value );
+}
+
+template < typename Value >
+inline void valueToJSON( const HTMLTemplateEngine&, const Value& value, nlohmann::json& data )
 {
     std::optional< URL > urlOpt;
 
@@ -107,25 +134,36 @@ inline void valueToJSON( HTMLTemplateEngine&, const Value& value, nlohmann::json
         urlOpt = engine.pLinker->link( value );
     }*/
 
-    std::ostringstream os;
+    std::string str, strBuffer;
     if( urlOpt.has_value() )
     {
-        os << "<a href=\"" << javascriptHREF( urlOpt.value() ) << "\">" << escapeHTML( toString( value ) ) << "</a>";
+        str.append( "<a href=\"" );
+        str.append( javascriptHREF( urlOpt.value() ) );
+        str.append( "\">" );
+        escapeValue( value, strBuffer, str );
+        str.append( "</a>" );
     }
     else
     {
-        os << escapeHTML( toString( value ) );
+        escapeValue( value, strBuffer, str );
     }
 
-    data.push_back( os.str() );
+    data.push_back( std::move( str ) );
 }
 
+// plain cell text for the native graph layout which draws its own tables
 template < typename Value >
-inline void graphValueToJSON( HTMLTemplateEngine&, const Value& value, nlohmann::json& data )
+inline void graphValueToText( const Value& value, nlohmann::json& data )
 {
-    std::ostringstream os;
+    std::string str, strBuffer;
+    escapeValue( value, strBuffer, str );
+    data.push_back( std::move( str ) );
+}
 
-    os << "<td";
+template < typename Value >
+inline void graphValueToJSON( const HTMLTemplateEngine&, const Value& value, nlohmann::json& data )
+{
+    std::string str( "<td" );
 
     std::optional< URL > urlOpt;
     /*if( engine.pLinker )
@@ -140,21 +178,22 @@ inline void graphValueToJSON( HTMLTemplateEngine&, const Value& value, nlohmann:
     }
     else*/
     {
-        os << ">" << escapeHTML( toString( value ) ) << "</td>";
+        std::string strBuffer;
+        str.push_back( '>' );
+        escapeValue( value, strBuffer, str );
+        str.append( "</td>" );
     }
 
-    data.push_back( os.str() );
+    data.push_back( std::move( str ) );
 }
 
 template < typename Value >
-inline void graphValueToJSON( HTMLTemplateEngine&,
+inline void graphValueToJSON( const HTMLTemplateEngine&,
                               const Value&                  value,
                               const std::optional< Value >& bookmarkOpt,
                               nlohmann::json&               data )
 {
-    std::ostringstream os;
-
-    os << "<td";
+    std::string str( "<td" );
 
     std::optional< URL > urlOpt;
     /*if( engine.pLinker )
@@ -164,13 +203,18 @@ inline void graphValueToJSON( HTMLTemplateEngine&,
 
     if( bookmarkOpt.has_value() )
     {
-        os << " ID=\"" << escapeHTML( toString( bookmarkOpt.value() ) ) << "\"";
+        const std::string strBookmark = toString( bookmarkOpt.value() );
+        str.append( " ID=\"" );
+        escapeHTML( strBookmark, str );
+        str.push_back( '\"' );
         if( !urlOpt.has_value() )
         {
             // ensure href because graphviz will NOT generate ID if no href present in <td>
             URL url;
-            url.set_fragment( toString( bookmarkOpt.value() ) );
-            os << " href=\"" << javascriptHREF( url ) << "\"";
+            url.set_fragment( strBookmark );
+            str.append( " href=\"" );
+            str.append( javascriptHREF( url ) );
+            str.push_back( '\"' );
         }
     }
 
@@ -181,15 +225,18 @@ inline void graphValueToJSON( HTMLTemplateEngine&,
     }
     else*/
     {
-        os << ">" << escapeHTML( toString( value ) ) << "</td>";
+        std::string strBuffer;
+        str.push_back( '>' );
+        escapeValue( value, strBuffer, str );
+        str.append( "</td>" );
     }
 
-    data.push_back( os.str() );
+    data.push_back( std::move( str ) );
 }
 
-template < typename Value >
-inline void
-valueVectorToJSON( HTMLTemplateEngine& engine, const ValueVector< Value >& textVector, nlohmann::json& data )
+// Values is the ValueVector of any Value which cannot be deduced through ContainerTraits
+template < typename Values >
+inline void valueVectorToJSON( const HTMLTemplateEngine& engine, const Values& textVector, nlohmann::json& data )
 {
     for( const auto& text : textVector )
     {
@@ -198,17 +245,19 @@ valueVectorToJSON( HTMLTemplateEngine& engine, const ValueVector< Value >& textV
 }
 
 template < typename T >
-inline void addOptionalBookmark( HTMLTemplateEngine&, T& element, nlohmann::json& data )
+inline void addOptionalBookmark( const HTMLTemplateEngine&, T& element, nlohmann::json& data )
 {
     if( element.m_bookmark.has_value() )
     {
         data[ "has_bookmark" ] = true;
-        data[ "bookmark" ]     = escapeHTML( toString( element.m_bookmark.value() ) );
+        std::string strBookmark, strBuffer;
+        escapeValue( element.m_bookmark.value(), strBuffer, strBookmark );
+        data[ "bookmark" ] = std::move( strBookmark );
     }
 }
 
 template < typename T >
-inline bool addOptionalLink( HTMLTemplateEngine&, T& element, nlohmann::json& data )
+inline bool addOptionalLink( const HTMLTemplateEngine&, T& element, nlohmann::json& data )
 {
     if( element.m_url.has_value() )
     {
@@ -220,7 +269,7 @@ inline bool addOptionalLink( HTMLTemplateEngine&, T& element, nlohmann::json& da
 }
 
 template < typename Value >
-inline void renderLine( HTMLTemplateEngine& engine, const Line< Value >& line, std::ostream& os )
+inline void renderLine( const HTMLTemplateEngine& engine, const Line< Value >& line, std::ostream& os )
 {
     nlohmann::json data( { { "style", "multiline_default" },
                            { "elements", nlohmann::json::array() },
@@ -243,7 +292,7 @@ inline void renderLine( HTMLTemplateEngine& engine, const Line< Value >& line, s
 }
 
 template < typename Value >
-inline void renderMultiline( HTMLTemplateEngine& engine, const Multiline< Value >& multiline, std::ostream& os )
+inline void renderMultiline( const HTMLTemplateEngine& engine, const Multiline< Value >& multiline, std::ostream& os )
 {
     nlohmann::json data( { { "style", "multiline_default" },
                            { "elements", nlohmann::json::array() },
@@ -268,32 +317,183 @@ inline void renderMultiline( HTMLTemplateEngine& engine, const Multiline< Value
 }
 
 template < typename Value >
-inline void renderContainer( HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os );
+inline void renderContainer( const HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os,
+                             std::size_t szDepth = 0U, const ContainerDigests* pDigests = nullptr );
+
+// counts szBudget down by the number of values in the container returning true once it is exhausted
+template < typename Value >
+inline bool exceedsGrainSize( const Container< Value >& container, std::size_t& szBudget )
+{
+    struct Visitor
+    {
+        std::size_t& szBudget;
+
+        bool consume( std::size_t szSize ) const
+        {
+            szBudget = ( szSize < szBudget ) ? szBudget - szSize : 0U;
+            return szBudget == 0U;
+        }
+        bool consume( const ContainerVector< Value >& children ) const
+        {
+            for( const auto& child : children )
+            {
+                if( exceedsGrainSize( child, szBudget ) )
+                    return true;
+            }
+            return false;
+        }
+
+        bool operator()( const Line< Value >& ) const { return consume( 1U ); }
+        bool operator()( const Multiline< Value >& multiline ) const { return consume( multiline.m_elements.size() ); }
+        bool operator()( const Branch< Value >& branch ) const
+        {
+            return consume( branch.m_label.size() ) || consume( branch.m_elements );
+        }
+        bool operator()( const Table< Value >& table ) const
+        {
+            if( consume( table.m_headings.size() ) )
+                return true;
+            for( const auto& row : table.m_rows )
+            {
+                if( consume( row ) )
+                    return true;
+            }
+            return false;
+        }
+        // always worth scheduling anything that runs an external tool
+        bool operator()( const Plot< Value >& ) const { return consume( szBudget ); }
+        bool operator()( const Graph< Value >& ) const { return consume( szBudget ); }
+
+    } visitor{ szBudget };
+
+    return std::visit( visitor, container );
+}
+
+// renders child containers in place when the parent template prints their placeholder.
+// With a thread pool children above the grain size are rendered ahead in parallel and
+// their output is written when the placeholder is reached.  Their output is buffered in
+// a DeferredOutput so that pending plots and graphs within them stay pending, created
+// from the parent's DeferredOutput if any so that they belong to the same render.
+template < typename Value >
+class ContainerSlots : public TemplateSlots
+{
+public:
+    // szDepth is the depth of the children below the root and pDigests those of the fragments of the render
+    ContainerSlots( const HTMLTemplateEngine& engine, std::ostream& os, std::size_t szDepth,
+                    const ContainerDigests* pDigests )
+        : m_engine( engine )
+        , m_pParentOutput( DeferredOutput::get( os ) )
+        , m_szDepth( szDepth )
+        , m_pDigests( pDigests )
+    {
+        if( m_engine.getThreadPool() )
+        {
+            m_pTaskGroup = std::make_unique< ThreadPool::TaskGroup >( *m_engine.getThreadPool() );
+        }
+    }
+
+    nlohmann::json add( const Container< Value >& container )
+    {
+        const std::size_t szSlot = m_slots.size();
+        m_slots.push_back( Slot{ &container, nullptr } );
+
+        std::size_t szBudget = m_engine.getGrainSize();
+        if( m_pTaskGroup && exceedsGrainSize( container, szBudget ) )
+        {
+            m_slots.back().pOutput
+                = m_pParentOutput ? m_pParentOutput->createChild() : std::make_unique< DeferredOutput >();
+            m_pTaskGroup->run(
+                [ &engine = m_engine, &container, pOutput = m_slots.back().pOutput.get(), szDepth = m_szDepth,
+                  pDigests = m_pDigests ]()
+                {
+                    std::ostream osChild( pOutput );
+                    renderContainer( engine, container, osChild, szDepth, pDigests );
+                } );
+        }
+
+        return placeholder( szSlot );
+    }
+
+    void write( std::size_t szSlot, std::ostream& os ) override
+    {
+        Slot& slot = m_slots[ szSlot ];
+        if( slot.pOutput )
+        {
+            if( !m_bJoined )
+            {
+                m_pTaskGroup->wait();
+                m_bJoined = true;
+            }
+            slot.pOutput->writeTo( os );
+            slot.pOutput.reset();
+        }
+        else
+        {
+            renderContainer( m_engine, *slot.pContainer, os, m_szDepth, m_pDigests );
+        }
+    }
+
+    std::size_t             getDepth() const { return m_szDepth; }
+    const ContainerDigests* getDigests() const { return m_pDigests; }
+
+private:
+    struct Slot
+    {
+        const Container< Value >*         pContainer;
+        std::unique_ptr< DeferredOutput > pOutput;
+    };
+
+    const HTMLTemplateEngine&                m_engine;
+    const DeferredOutput*                    m_pParentOutput;
+    const std::size_t                        m_szDepth;
+    const ContainerDigests*                  m_pDigests;
+    std::vector< Slot >                      m_slots;
+    std::unique_ptr< ThreadPool::TaskGroup > m_pTaskGroup;
+    bool                                     m_bJoined = false;
+};
 
 template < typename Value >
-inline void renderBranch( HTMLTemplateEngine& engine, const Branch< Value >& branch, std::ostream& os )
+inline nlohmann::json renderChild( const HTMLTemplateEngine& engine, ContainerSlots< Value >& slots,
+                                   const Container< Value >& container )
+{
+    if( engine.isStreaming() )
+    {
+        return slots.add( container );
+    }
+    else
+    {
+        std::ostringstream osChild;
+        renderContainer( engine, container, osChild, slots.getDepth(), slots.getDigests() );
+        return osChild.str();
+    }
+}
+
+template < typename Value >
+inline void renderBranch( const HTMLTemplateEngine& engine, const Branch< Value >& branch, std::ostream& os,
+                          std::size_t szDepth, const ContainerDigests* pDigests )
 {
     nlohmann::json data( { { "style", "branch_default" },
                            { "has_bookmark", false },
                            { "bookmark", "" },
+                           { "collapsed", engine.isCollapsed( szDepth, branch.m_elements.size() ) },
                            { "label", nlohmann::json::array() },
                            { "elements", nlohmann::json::array() } } );
 
     addOptionalBookmark( engine, branch, data );
     valueVectorToJSON( engine, branch.m_label, data[ "label" ] );
 
+    ContainerSlots< Value > slots( engine, os, szDepth + 1U, pDigests );
     for( const auto& pChildElement : branch.m_elements )
     {
-        std::ostringstream osChild;
-        renderContainer( engine, pChildElement, osChild );
-        data[ "elements" ].push_back( osChild.str() );
+        data[ "elements" ].push_back( renderChild( engine, slots, pChildElement ) );
     }
 
-    engine.render( HTMLTemplateEngine::eBranch, data, os );
+    engine.render( HTMLTemplateEngine::eBranch, data, os, &slots );
 }
 
 template < typename Value >
-inline void renderTable( HTMLTemplateEngine& engine, const Table< Value >& table, std::ostream& os )
+inline void renderTable( const HTMLTemplateEngine& engine, const Table< Value >& table, std::ostream& os,
+                         std::size_t szDepth, const ContainerDigests* pDigests )
 {
     nlohmann::json data( { { "headings", nlohmann::json::array() }, { "rows", nlohmann::json::array() } } );
 
@@ -301,29 +501,31 @@ inline void renderTable( HTMLTemplateEngine& engine, const Table< Value >& table
     {
         valueVectorToJSON( engine, table.m_headings, data[ "headings" ] );
     }
+    ContainerSlots< Value > slots( engine, os, szDepth + 1U, pDigests );
     for( const auto& pRow : table.m_rows )
     {
         nlohmann::json row( { { "values", nlohmann::json::array() } } );
         for( const auto& pContainer : pRow )
         {
-            std::ostringstream osChild;
-            renderContainer( engine, pContainer, osChild );
-            row[ "values" ].push_back( osChild.str() );
+            row[ "values" ].push_back( renderChild( engine, slots, pContainer ) );
         }
-        data[ "rows" ].push_back( row );
+        data[ "rows" ].push_back( std::move( row ) );
     }
 
-    engine.render( HTMLTemplateEngine::eTable, data, os );
+    engine.render( HTMLTemplateEngine::eTable, data, os, &slots );
 }
 
 template < typename Value >
-inline void renderPlot( HTMLTemplateEngine& engine, const Plot< Value >& plot, std::ostream& os )
+inline void renderPlot( const HTMLTemplateEngine& engine, const Plot< Value >& plot, std::ostream& os )
 {
     using namespace std::string_literals;
 
-    nlohmann::json data( { { "headings", nlohmann::json::array() }, { "points", nlohmann::json::array() } } );
+    nlohmann::json data( { { "headings", nlohmann::json::array() },
+                           { "points", nlohmann::json::array() },
+                           { "style", { { "bars", false }, { "lines", false }, { "scatter", false } } } } );
 
     valueVectorToJSON( engine, plot.m_heading, data[ "headings" ] );
+    data[ "style" ][ plot.m_style.str() ] = true;
 
     for( const auto& point : plot.m_points )
     {
@@ -338,10 +540,13 @@ inline void renderPlot( HTMLTemplateEngine& engine, const Plot< Value >& plot, s
 }
 
 template < typename Value >
-inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph, std::ostream& os )
+inline void renderGraph( const HTMLTemplateEngine& engine, const Graph< Value >& graph, std::ostream& os )
 {
     using namespace std::string_literals;
 
+    // the native layout is given the plain text of each cell and node indices instead of the dot syntax
+    const bool bNativeLayout = engine.isNativeGraph( graph.m_nodes.size() );
+
     nlohmann::json data( { { "rank_direction", graph.m_rankDirection.str() },
                            { "nodes", nlohmann::json::array() },
                            { "edges", nlohmann::json::array() },
@@ -350,13 +555,11 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
     std::vector< std::string > nodeNames;
     for( const auto& node : graph.m_nodes )
     {
-        std::ostringstream osNodeName;
-        osNodeName << "node_" << nodeNames.size();
-        nodeNames.push_back( osNodeName.str() );
+        nodeNames.push_back( "node_" + std::to_string( nodeNames.size() ) );
 
         nlohmann::json nodeData( {
 
-            { "name", osNodeName.str() },
+            { "name", nodeNames.back() },
             { "colour", node.m_colour.str() },
             { "bgcolour", node.m_background_colour.str() },
             { "border_width", node.m_border_width },
@@ -373,10 +576,31 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
 
         // addOptionalBookmark( engine, node, nodeData );
 
+        if( bNativeLayout )
+        {
+            nodeData[ "text" ] = nlohmann::json::array();
+            if( node.m_bookmark.has_value() )
+            {
+                const std::string strBookmark = toString( node.m_bookmark.value() );
+                URL               url;
+                url.set_fragment( strBookmark );
+                nodeData[ "bookmark" ]      = escapeHTML( strBookmark );
+                nodeData[ "bookmark_href" ] = javascriptHREF( url );
+            }
+        }
+
         bool bFirst = true;
         for( const ValueVector< Value >& row : node.m_rows )
         {
             nlohmann::json rowData( { { "values", nlohmann::json::array() } } );
+            if( bNativeLayout )
+            {
+                nlohmann::json& rowText = nodeData[ "text" ].emplace_back( nlohmann::json::array() );
+                for( const Value& value : row )
+                {
+                    graphValueToText( value, rowText );
+                }
+            }
             for( const Value& value : row )
             {
                 // NOTE graph value generates <td id="bookmark">value</td> so can generate href in graphviz
@@ -399,14 +623,12 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
     std::vector< std::string > subgraphNames;
     for( const auto& subgraph : graph.m_subgraphs )
     {
-        std::ostringstream osNodeName;
         // NOTE: MUST start with 'cluster'
-        osNodeName << "cluster_" << subgraphNames.size();
-        subgraphNames.push_back( osNodeName.str() );
+        subgraphNames.push_back( "cluster_" + std::to_string( subgraphNames.size() ) );
 
         nlohmann::json subgraphData( {
 
-            { "name", osNodeName.str() },
+            { "name", subgraphNames.back() },
             { "colour", subgraph.m_colour.str() },
             { "rows", nlohmann::json::array() },
             { "nodes", nlohmann::json::array() },
@@ -424,6 +646,20 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
         VERIFY_RTE_MSG( !subgraph.m_bookmark.has_value(), "Subgraph bookmark deprecated" );
         // addOptionalBookmark( engine, subgraph, subgraphData );
 
+        if( bNativeLayout )
+        {
+            subgraphData[ "text" ]         = nlohmann::json::array();
+            subgraphData[ "node_indices" ] = nlohmann::json::array();
+            for( const ValueVector< Value >& row : subgraph.m_rows )
+            {
+                nlohmann::json& rowText = subgraphData[ "text" ].emplace_back( nlohmann::json::array() );
+                for( const Value& value : row )
+                {
+                    graphValueToText( value, rowText );
+                }
+            }
+        }
+
         for( const ValueVector< Value >& row : subgraph.m_rows )
         {
             nlohmann::json rowData( { { "values", nlohmann::json::array() } } );
@@ -440,6 +676,10 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
         {
             VERIFY_RTE_MSG( ( iNode ) >= 0 && ( iNode < nodeNames.size() ), "Invalid subgraph node id of: " << iNode );
             subgraphData[ "nodes" ].push_back( nodeNames[ iNode ] );
+            if( bNativeLayout )
+            {
+                subgraphData[ "node_indices" ].push_back( iNode );
+            }
         }
 
         data[ "subgraphs" ].push_back( subgraphData );
@@ -473,41 +713,137 @@ inline void renderGraph( HTMLTemplateEngine& engine, const Graph< Value >& graph
             }
         }
 
+        if( bNativeLayout )
+        {
+            edgeData[ "source" ]     = edge.m_source;
+            edgeData[ "target" ]     = edge.m_target;
+            edgeData[ "label_text" ] = nlohmann::json::array();
+            if( edge.m_label.has_value() )
+            {
+                for( const auto& value : edge.m_label.value() )
+                {
+                    graphValueToText( value, edgeData[ "label_text" ] );
+                }
+            }
+        }
+
         data[ "edges" ].push_back( edgeData );
     }
 
+    // an svg written as an asset lists its bookmarks so that navigating to one loads it
+    if( engine.getAssets() )
+    {
+        data[ "bookmarks" ] = nlohmann::json::array();
+        for( const auto& node : graph.m_nodes )
+        {
+            if( node.m_bookmark.has_value() )
+            {
+                data[ "bookmarks" ].push_back( toString( node.m_bookmark.value() ) );
+            }
+        }
+    }
+
     engine.render( HTMLTemplateEngine::eGraph, data, os );
 }
 
 template < typename Value >
-inline void renderContainer( HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os )
+inline void renderElement( const HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os,
+                           std::size_t szDepth, const ContainerDigests* pDigests )
 {
     using namespace report;
 
     struct Visitor
     {
-        HTMLTemplateEngine& engine;
+        const HTMLTemplateEngine& engine;
 
         std::ostream& os;
 
+        std::size_t szDepth;
+
+        const ContainerDigests* pDigests;
+
         void operator()( const Line< Value >& line ) const { renderLine( engine, line, os ); }
         void operator()( const Multiline< Value >& multiline ) const { renderMultiline( engine, multiline, os ); }
-        void operator()( const Branch< Value >& branch ) const { renderBranch( engine, branch, os ); }
-        void operator()( const Table< Value >& table ) const { renderTable( engine, table, os ); }
+        void operator()( const Branch< Value >& branch ) const
+        {
+            renderBranch( engine, branch, os, szDepth, pDigests );
+        }
+        void operator()( const Table< Value >& table ) const { renderTable( engine, table, os, szDepth, pDigests ); }
         void operator()( const Plot< Value >& plot ) const { renderPlot( engine, plot, os ); }
         void operator()( const Graph< Value >& graph ) const { renderGraph( engine, graph, os ); }
 
-    } visitor{ engine, os };
+    } visitor{ engine, os, szDepth, pDigests };
 
     std::visit( visitor, container );
 }
 
+// With a fragment cache subtrees above the fragment size are looked up by their structural
+// hash and only rendered when not found.  The digests of all of them are computed in one pass
+// by the outermost call and passed down.  When the engine defers output a rendered fragment
+// may still contain pending plots and graphs so it is stored once the whole render completes.
+template < typename Value >
+inline void renderContainer( const HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os,
+                             std::size_t szDepth, const ContainerDigests* pDigests )
+{
+    ContentCache* pFragmentCache = engine.getFragmentCache();
+    if( !pFragmentCache )
+    {
+        renderElement( engine, container, os, szDepth, nullptr );
+        return;
+    }
+
+    // NOTE: nested renders complete before this returns so they may refer to the digests here
+    ContainerDigests digests;
+    if( !pDigests )
+    {
+        digests  = hashSubtrees( container, engine.getFragmentSize() );
+        pDigests = &digests;
+    }
+    auto iFind = pDigests->find( &container );
+    if( iFind == pDigests->end() )
+    {
+        renderElement( engine, container, os, szDepth, pDigests );
+        return;
+    }
+
+    const std::string strCacheKey = engine.fragmentCacheKey( iFind->second, szDepth );
+    DeferredOutput*   pOutput     = engine.isDeferred() ? DeferredOutput::get( os ) : nullptr;
+    std::optional< std::string > fragmentOpt = pFragmentCache->load( strCacheKey );
+
+    // NOTE: a cached fragment is rendered again when the svg assets it refers to have been removed
+    if( fragmentOpt.has_value() && ( !engine.getAssets() || engine.getAssets()->hasPlaceholderFiles( *fragmentOpt ) ) )
+    {
+        os << fragmentOpt.value();
+    }
+    else if( pOutput )
+    {
+        auto pFragment = pOutput->createChild();
+        {
+            std::ostream osFragment( pFragment.get() );
+            renderElement( engine, container, osFragment, szDepth, pDigests );
+        }
+        engine.deferFragment( *pOutput, strCacheKey, pFragment->share() );
+        pFragment->writeTo( os );
+    }
+    else
+    {
+        std::ostringstream osFragment;
+        renderElement( engine, container, osFragment, szDepth, pDigests );
+        const std::string strFragment = osFragment.str();
+        pFragmentCache->store( strCacheKey, strFragment );
+        os << strFragment;
+    }
+}
+
 template < typename Value >
-inline void renderReport( HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os )
+inline void renderReport( const HTMLTemplateEngine& engine, const Container< Value >& container, std::ostream& os )
 {
-    std::ostringstream osContainer;
-    renderContainer( engine, container, osContainer );
-    nlohmann::json report( { { "body", osContainer.str() }, { "reports", nlohmann::json::array() } } );
+    ContainerSlots< Value > slots( engine, os, 0U, nullptr );
+    nlohmann::json report( { { "body", renderChild( engine, slots, container ) },
+                             { "reports", nlohmann::json::array() },
+                             { "has_navigation", false },
+                             { "has_bookmark_map", false } } );
+    engine.addPageAssets( report );
 
     /*
         for( const auto& reporterID : shortcuts.get() )
@@ -520,7 +856,328 @@ inline void renderReport( HTMLTemplateEngine& engine, const Container< Value >&
             report[ "reports" ].push_back( reporterIDData );
         }*/
 
-    engine.render( HTMLTemplateEngine::eReport, report, os );
+    engine.render( HTMLTemplateEngine::eReport, report, os, &slots );
+}
+
+// Render writes to the stream it is passed which defers plots and graphs when the engine does
+template < typename Render >
+inline void renderDeferred( const HTMLTemplateEngine& engine, std::ostream& os, Render&& render )
+{
+    if( engine.isDeferred() )
+    {
+        // plots and graphs are spliced in as their processes complete
+        DeferredOutput output( os );
+        std::ostream   osDeferred( &output );
+        try
+        {
+            render( osDeferred );
+        }
+        catch( ... )
+        {
+            engine.discardGraphBatch( output );
+            engine.discardFragments( output );
+            throw;
+        }
+        engine.flushGraphBatch( output );
+        try
+        {
+            output.flush();
+        }
+        catch( ... )
+        {
+            engine.discardFragments( output );
+            throw;
+        }
+        engine.storeFragments( output );
+    }
+    else
+    {
+        render( os );
+    }
+}
+
+template < typename Value >
+inline void renderDocument( const Container< Value >& report, std::ostream& os, const HTMLTemplateEngine& engine )
+{
+    renderDeferred( engine, os, [ & ]( std::ostream& osReport ) { renderReport( engine, report, osReport ); } );
+}
+
+template < typename Value >
+inline std::string labelToString( const ValueVector< Value >& label )
+{
+    std::string str;
+    for( const auto& value : label )
+    {
+        str.append( toString( value ) );
+    }
+    return str;
+}
+
+// calls functor with every bookmark in the container in document order
+template < typename Value, typename Functor >
+inline void forEachBookmark( const Container< Value >& container, Functor&& functor )
+{
+    struct Visitor
+    {
+        Functor& functor;
+
+        void optional( const Boxed< Value >& bookmark ) const
+        {
+            if( bookmark.has_value() )
+            {
+                functor( toString( bookmark.value() ) );
+            }
+        }
+        void operator()( const Line< Value >& line ) const { optional( line.m_bookmark ); }
+        void operator()( const Multiline< Value >& multiline ) const { optional( multiline.m_bookmark ); }
+        void operator()( const Branch< Value >& branch ) const
+        {
+            optional( branch.m_bookmark );
+            for( const auto& element : branch.m_elements )
+            {
+                std::visit( *this, element );
+            }
+        }
+        void operator()( const Table< Value >& table ) const
+        {
+            for( const auto& row : table.m_rows )
+            {
+                for( const auto& cell : row )
+                {
+                    std::visit( *this, cell );
+                }
+            }
+        }
+        void operator()( const Plot< Value >& ) const {}
+        void operator()( const Graph< Value >& graph ) const
+        {
+            for( const auto& node : graph.m_nodes )
+            {
+                if( node.m_bookmark.has_value() )
+                {
+                    functor( toString( node.m_bookmark.value() ) );
+                }
+            }
+        }
+
+    } visitor{ functor };
+
+    std::visit( visitor, container );
+}
+
+/***
+    PageSplitter
+
+    Splits a report into pages of about the page size at Branch boundaries.  Each child of a
+    branch is rendered on its own and the children are packed in order into pages.  A child
+    branch that alone exceeds the page size is abandoned as soon as it does and split in turn.
+    Under a deferred engine its text is checked while still held back behind pending plots and
+    graphs so only those before the point it overflowed are generated for the abandoned render.
+    Children rendered ahead in parallel by a thread pool are still rendered in full.
+    A page holds consecutive children of one branch nested within the labels of the branches
+    above it so that every page reads as a slice of the whole report.
+*/
+template < typename Value >
+class PageSplitter
+{
+public:
+    PageSplitter( const HTMLTemplateEngine& engine, HTMLPageWriter& writer, std::size_t szPageSize )
+        : m_engine( engine )
+        , m_writer( writer )
+        , m_szPageSize( szPageSize )
+    {
+        VERIFY_RTE_MSG( m_szPageSize != 0U, "Invalid report page size: " << m_szPageSize );
+    }
+
+    void split( const Container< Value >& report )
+    {
+        if( const Branch< Value >* pBranch = std::get_if< Branch< Value > >( &report ) )
+        {
+            splitBranch( *pBranch );
+        }
+        else
+        {
+            addPiece( report, render( report, 0U, std::numeric_limits< std::size_t >::max() ).value() );
+            flush();
+        }
+    }
+
+private:
+    struct Ancestor
+    {
+        const Branch< Value >* pBranch;
+        bool                   bStarted;
+    };
+
+    std::optional< std::string > render( const Container< Value >& container, std::size_t szDepth,
+                                         std::size_t szLimit ) const
+    {
+        PageBuffer   buffer( szLimit );
+        std::ostream os( &buffer );
+        os.exceptions( std::ios::badbit );
+        bool bDeferredOverflow = false;
+        try
+        {
+            const auto renderPiece = [ & ]( std::ostream& osPiece )
+            {
+                DeferredOutput* pOutput = DeferredOutput::get( osPiece );
+                if( pOutput )
+                {
+                    pOutput->setLimit( szLimit );
+                    osPiece.exceptions( std::ios::badbit );
+                }
+                try
+                {
+                    renderContainer( m_engine, container, osPiece, szDepth );
+                }
+                catch( ... )
+                {
+                    bDeferredOverflow = pOutput && pOutput->hasOverflowed();
+                    throw;
+                }
+            };
+            renderDeferred( m_engine, os, renderPiece );
+            os.flush();
+        }
+        catch( ... )
+        {
+            if( buffer.hasOverflowed() || bDeferredOverflow )
+            {
+                return {};
+            }
+            throw;
+        }
+        return buffer.take();
+    }
+
+    void splitBranch( const Branch< Value >& branch )
+    {
+        m_ancestors.push_back( Ancestor{ &branch, false } );
+        for( const auto& child : branch.m_elements )
+        {
+            std::optional< std::string > pieceOpt = render( child, m_ancestors.size(), m_szPageSize );
+            if( !pieceOpt.has_value() )
+            {
+                if( const Branch< Value >* pChildBranch = std::get_if< Branch< Value > >( &child ) )
+                {
+                    flush();
+                    splitBranch( *pChildBranch );
+                    continue;
+                }
+                // anything else that cannot be split has a page of its own
+                flush();
+                pieceOpt = render( child, m_ancestors.size(), std::numeric_limits< std::size_t >::max() );
+            }
+            if( !m_pieces.empty() && ( m_szPageBytes + pieceOpt.value().size() > m_szPageSize ) )
+            {
+                flush();
+            }
+            addPiece( child, std::move( pieceOpt.value() ) );
+        }
+        flush();
+        m_ancestors.pop_back();
+    }
+
+    void addPiece( const Container< Value >& container, std::string strPiece )
+    {
+        if( const Branch< Value >* pBranch = std::get_if< Branch< Value > >( &container ) )
+        {
+            // the page is titled by the first and last branch on it wherever they fall among the pieces
+            ( m_strFirstLabel.empty() ? m_strFirstLabel : m_strLastLabel ) = labelToString< Value >( pBranch->m_label );
+        }
+        forEachBookmark(
+            container, [ & ]( const std::string& strBookmark ) { m_writer.addBookmark( strBookmark ); } );
+        m_szPageBytes += strPiece.size();
+        m_pieces.push_back( std::move( strPiece ) );
+    }
+
+    // wraps the pieces in their ancestor branches and completes the page
+    void flush()
+    {
+        if( m_pieces.empty() )
+        {
+            return;
+        }
+
+        nlohmann::json elements = nlohmann::json::array();
+        for( std::string& strPiece : m_pieces )
+        {
+            elements.push_back( std::move( strPiece ) );
+        }
+        m_pieces.clear();
+        m_szPageBytes = 0U;
+
+        // titled by the branch path and the range of child branches on the page
+        std::string strTitle;
+        for( const Ancestor& ancestor : m_ancestors )
+        {
+            strTitle.append( strTitle.empty() ? "" : " / " );
+            strTitle.append( labelToString< Value >( ancestor.pBranch->m_label ) );
+        }
+        if( !m_strFirstLabel.empty() )
+        {
+            strTitle.append( " / " + m_strFirstLabel );
+            if( !m_strLastLabel.empty() )
+            {
+                strTitle.append( " - " + m_strLastLabel );
+            }
+        }
+        m_strFirstLabel.clear();
+        m_strLastLabel.clear();
+
+        for( auto i = m_ancestors.rbegin(), iEnd = m_ancestors.rend(); i != iEnd; ++i )
+        {
+            nlohmann::json data( { { "style", "branch_default" },
+                                   { "has_bookmark", false },
+                                   { "bookmark", "" },
+                                   { "collapsed", false },
+                                   { "label", nlohmann::json::array() },
+                                   { "elements", std::move( elements ) } } );
+            valueVectorToJSON( m_engine, i->pBranch->m_label, data[ "label" ] );
+
+            // a branch split across pages is only bookmarked on the first of them
+            if( !i->bStarted )
+            {
+                addOptionalBookmark( m_engine, *i->pBranch, data );
+                if( i->pBranch->m_bookmark.has_value() )
+                {
+                    m_writer.addBookmark( toString( i->pBranch->m_bookmark.value() ) );
+                }
+                i->bStarted = true;
+            }
+
+            std::ostringstream os;
+            m_engine.render( HTMLTemplateEngine::eBranch, data, os );
+            elements = nlohmann::json::array( { os.str() } );
+        }
+
+        m_writer.addPage( strTitle, elements.front().get< std::string >() );
+    }
+
+    const HTMLTemplateEngine&  m_engine;
+    HTMLPageWriter&            m_writer;
+    const std::size_t          m_szPageSize;
+    std::vector< Ancestor >    m_ancestors;
+    std::vector< std::string > m_pieces;
+    std::size_t                m_szPageBytes = 0U;
+    std::string                m_strFirstLabel;
+    std::string                m_strLastLabel;
+};
+
+template < typename Value >
+inline std::vector< boost::filesystem::path > renderPages( const Container< Value >& report,
+                                                           const boost::filesystem::path& directory,
+                                                           const HTMLTemplateEngine& engine, std::size_t szPageSize )
+{
+    HTMLPageWriter writer( engine, directory );
+    PageSplitter< Value >( engine, writer, szPageSize ).split( report );
+
+    std::string strTitle;
+    if( const Branch< Value >* pBranch = std::get_if< Branch< Value > >( &report ) )
+    {
+        strTitle = labelToString< Value >( pBranch->m_label );
+    }
+    return writer.finish( strTitle );
 }
 
 } // namespace detail
@@ -528,27 +1185,63 @@ inline void renderReport( HTMLTemplateEngine& engine, const Container< Value >&
 template < typename Value >
 inline void renderHTML( const Container< Value >& report, std::ostream& os, HTMLTemplateEngine& engine )
 {
-    detail::renderReport( engine, report, os );
+    detail::renderDocument( report, os, engine );
 }
 
 template < typename Value, typename Linker >
 inline void renderHTML( const Container< Value >& report, std::ostream& os, Linker&, HTMLTemplateEngine& engine )
 {
-    detail::renderReport( engine, report, os );
+    detail::renderDocument( report, os, engine );
+}
+
+template < typename Value >
+inline void renderHTML( const Container< Value >& report, OutputSink& sink, HTMLTemplateEngine& engine )
+{
+    {
+        OutputStream os( sink );
+        detail::renderDocument( report, os, engine );
+        os.flush();
+    }
+    sink.close();
+}
+
+template < typename Value >
+inline void renderHTML( const Container< Value >& report, OutputSink& sink )
+{
+    {
+        OutputStream os( sink );
+        detail::renderDocument( report, os, HTMLTemplateEngine::getDefault() );
+        os.flush();
+    }
+    sink.close();
+}
+
+template < typename Value >
+inline std::vector< boost::filesystem::path > renderHTMLPages( const Container< Value >& report,
+                                                               const boost::filesystem::path& directory,
+                                                               HTMLTemplateEngine& engine, std::size_t szPageSize )
+{
+    return detail::renderPages( report, directory, engine, szPageSize );
+}
+
+template < typename Value >
+inline std::vector< boost::filesystem::path > renderHTMLPages( const Container< Value >& report,
+                                                               const boost::filesystem::path& directory,
+                                                               std::size_t szPageSize )
+{
+    return detail::renderPages( report, directory, HTMLTemplateEngine::getDefault(), szPageSize );
 }
 
 template < typename Value >
 inline void renderHTML( const Container< Value >& report, std::ostream& os )
 {
-    HTMLTemplateEngine engine{ false };
-    renderHTML( report, os, engine );
+    detail::renderDocument( report, os, HTMLTemplateEngine::getDefault() );
 }
 
 template < typename Value, typename Linker >
-inline void renderHTML( const Container< Value >& report, std::ostream& os, Linker& linker )
+inline void renderHTML( const Container< Value >& report, std::ostream& os, Linker& )
 {
-    HTMLTemplateEngine engine{ false };
-    renderHTML( report, os, linker, engine );
+    detail::renderDocument( report, os, HTMLTemplateEngine::getDefault() );
 }
 
 } // namespace report
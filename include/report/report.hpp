@@ -21,12 +21,15 @@
 #ifndef GUARD_2023_October_17_reports
 #define GUARD_2023_October_17_reports
 
+#include "report/boxed.hpp"
 #include "report/value.hpp"
 #include "report/url.hpp"
 #include "report/colours.hxx"
 
 #include "common/serialisation.hpp"
 
+#include <boost/serialization/version.hpp>
+
 #include <vector>
 #include <ostream>
 #include <optional>
@@ -53,12 +56,14 @@ class Plot;
 template < typename Value >
 class Graph;
 
+// NOTE: every Container is as large as its largest alternative so the rarely used url and
+// bookmark of the common elements are Boxed out of line
 template < typename Value >
 using Container
     = std::variant< Line< Value >, Multiline< Value >, Branch< Value >, Table< Value >, Plot< Value >, Graph< Value > >;
 
 template < typename Value >
-using ContainerVector = std::vector< Container< Value > >;
+using ContainerVector = ReportVector< Value, Container< Value > >;
 
 /***
     Line{ Value, opt< URL >, opt< Bookmark > }
@@ -79,11 +84,11 @@ class Line
 public:
     using ValueType = Value;
 
-    Value                  m_element;
-    std::optional< URL >   m_url;
-    std::optional< Value > m_bookmark;
-    Colour                 m_colour            = Colour::black;
-    Colour                 m_background_colour = Colour::white;
+    Value          m_element;
+    Boxed< URL >   m_url;
+    Boxed< Value > m_bookmark;
+    Colour         m_colour            = Colour::black;
+    Colour         m_background_colour = Colour::white;
 };
 
 // Line deduction guide
@@ -120,28 +125,31 @@ class Multiline
 public:
     using ValueType = Value;
 
-    ValueVector< Value >   m_elements;
-    std::optional< URL >   m_url;
-    std::optional< Value > m_bookmark;
-    Colour                 m_colour            = Colour::black;
-    Colour                 m_background_colour = Colour::white;
+    ValueVector< Value > m_elements;
+    Boxed< URL >         m_url;
+    Boxed< Value >       m_bookmark;
+    Colour               m_colour            = Colour::black;
+    Colour               m_background_colour = Colour::white;
 };
 
 // Multiline deduction guide
-template < typename Value >
-Multiline( ValueVector< Value > ) -> Multiline< Value >;
+// NOTE: deduced from any std::vector since ValueVector< Value > depends on ContainerTraits
+template < typename Value, typename Allocator >
+Multiline( std::vector< Value, Allocator > ) -> Multiline< Value >;
 
-template < typename Value >
-Multiline( ValueVector< Value >, std::optional< URL > ) -> Multiline< Value >;
+template < typename Value, typename Allocator >
+Multiline( std::vector< Value, Allocator >, std::optional< URL > ) -> Multiline< Value >;
 
-template < typename Value >
-Multiline( ValueVector< Value >, std::optional< URL >, std::optional< Value > ) -> Multiline< Value >;
+template < typename Value, typename Allocator >
+Multiline( std::vector< Value, Allocator >, std::optional< URL >, std::optional< Value > ) -> Multiline< Value >;
 
-template < typename Value >
-Multiline( ValueVector< Value >, std::optional< URL >, std::optional< Value >, Colour ) -> Multiline< Value >;
+template < typename Value, typename Allocator >
+Multiline( std::vector< Value, Allocator >, std::optional< URL >, std::optional< Value >, Colour )
+    -> Multiline< Value >;
 
-template < typename Value >
-Multiline( ValueVector< Value >, std::optional< URL >, std::optional< Value >, Colour, Colour ) -> Multiline< Value >;
+template < typename Value, typename Allocator >
+Multiline( std::vector< Value, Allocator >, std::optional< URL >, std::optional< Value >, Colour, Colour )
+    -> Multiline< Value >;
 
 /***
     Branch{ vec< Value >, vec< Container >, opt< Bookmark > }
@@ -163,18 +171,19 @@ public:
 
     ValueVector< Value >     m_label;
     ContainerVector< Value > m_elements;
-    std::optional< Value >   m_bookmark;
+    Boxed< Value >           m_bookmark;
 };
 
 // Branch deduction guide
-template < typename Value >
-Branch( ValueVector< Value > label ) -> Branch< Value >;
+template < typename Value, typename Allocator >
+Branch( std::vector< Value, Allocator > label ) -> Branch< Value >;
 
-template < typename Value >
-Branch( ValueVector< Value >, ContainerVector< Value > ) -> Branch< Value >;
+template < typename Value, typename Allocator, typename ContainerAllocator >
+Branch( std::vector< Value, Allocator >, std::vector< Container< Value >, ContainerAllocator > ) -> Branch< Value >;
 
-template < typename Value >
-Branch( ValueVector< Value >, ContainerVector< Value >, std::optional< Value > ) -> Branch< Value >;
+template < typename Value, typename Allocator, typename ContainerAllocator >
+Branch( std::vector< Value, Allocator >, std::vector< Container< Value >, ContainerAllocator >,
+        std::optional< Value > ) -> Branch< Value >;
 
 /***
     Table{ vec< Value >, vec< vec< Container > > }
@@ -195,37 +204,85 @@ class Table
 public:
     using ValueType = Value;
 
-    ValueVector< Value >                    m_headings;
-    std::vector< ContainerVector< Value > > m_rows;
+    ValueVector< Value >                            m_headings;
+    ReportVector< Value, ContainerVector< Value > > m_rows;
 };
 
 // Table deduction guide
-template < typename Value >
-Table( ValueVector< Value > label ) -> Table< Value >;
+template < typename Value, typename Allocator >
+Table( std::vector< Value, Allocator > label ) -> Table< Value >;
 
-template < typename Value >
-Table( ValueVector< Value >, std::vector< ContainerVector< Value > > ) -> Table< Value >;
+template < typename Value, typename Allocator, typename RowAllocator >
+Table( std::vector< Value, Allocator >, std::vector< ContainerVector< Value >, RowAllocator > ) -> Table< Value >;
 
 /***
-    Plot{ vec< Value >, vec< Point > }
+    Plot{ vec< Value >, vec< Point >, style( bars ) }
+
+    Point{ x, y, optional hover label }
+
+    Plot Styles: bars, lines, scatter
 */
 template < typename Value >
 class Plot
 {
     friend class boost::serialization::access;
     template < class Archive >
-    inline void serialize( Archive& archive, const unsigned int )
+    inline void serialize( Archive& archive, const unsigned int version )
     {
         archive& m_heading;
         archive& m_points;
+        if( version >= 1 )
+        {
+            archive& m_style;
+        }
+        else
+        {
+            // loading a plot archived before it had a style
+            m_style = Style::bars;
+        }
     }
 
 public:
     using ValueType = Value;
     using Point     = ValueVector< Value >;
 
-    ValueVector< Value > m_heading;
-    std::vector< Point > m_points;
+    class Style
+    {
+    public:
+        enum Type
+        {
+            bars,
+            lines,
+            scatter,
+            TOTAL_STYLES
+        };
+
+        Style() = default;
+
+        inline constexpr Style( Type type )
+            : m_style( type )
+        {
+        }
+
+        inline const char* str() const
+        {
+            static const std::array< const char*, TOTAL_STYLES > g_styles = { "bars", "lines", "scatter" };
+            return g_styles[ m_style ];
+        }
+
+        template < class Archive >
+        inline void serialize( Archive& archive, const unsigned int )
+        {
+            archive& m_style;
+        }
+
+    private:
+        Type m_style = bars;
+    };
+
+    ValueVector< Value >         m_heading;
+    ReportVector< Value, Point > m_points;
+    Style                        m_style = Style::bars;
 };
 
 /***
@@ -303,9 +360,9 @@ public:
 
     public:
         using ID     = std::size_t;
-        using Vector = std::vector< Node >;
+        using Vector = ReportVector< Value, Node >;
 
-        std::vector< ValueVector< Value > > m_rows;
+        ReportVector< Value, ValueVector< Value > > m_rows;
 
         Colour                 m_colour = Colour::blue;
         std::optional< URL >   m_url;
@@ -328,10 +385,10 @@ public:
         }
 
     public:
-        using Vector = std::vector< Subgraph >;
+        using Vector = ReportVector< Value, Subgraph >;
 
-        std::vector< ValueVector< Value > > m_rows;
-        std::vector< typename Node::ID >    m_nodes;
+        ReportVector< Value, ValueVector< Value > > m_rows;
+        ReportVector< Value, typename Node::ID >    m_nodes;
 
         Colour                 m_colour = Colour::lightblue;
         std::optional< URL >   m_url;
@@ -353,7 +410,7 @@ public:
         }
 
     public:
-        using Vector = std::vector< Edge >;
+        using Vector = ReportVector< Value, Edge >;
 
         class Style
         {
@@ -399,7 +456,7 @@ public:
         bool   m_bIgnoreInLayout = false;
         int    line_width        = 1;
 
-        std::optional< std::vector< Value > > m_label;
+        std::optional< ValueVector< Value > > m_label;
     };
 
     typename Node::Vector     m_nodes;
@@ -410,4 +467,16 @@ public:
 
 } // namespace report
 
+// Plot version 1 added the style
+namespace boost::serialization
+{
+template < typename Value >
+struct version< report::Plot< Value > >
+{
+    typedef mpl::int_< 1 >      type;
+    typedef mpl::integral_c_tag tag;
+    BOOST_STATIC_CONSTANT( int, value = version::type::value );
+};
+} // namespace boost::serialization
+
 #endif // GUARD_2023_October_17_reports
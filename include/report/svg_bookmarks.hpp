@@ -0,0 +1,70 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_12_svg_bookmarks
+#define GUARD_2024_April_12_svg_bookmarks
+
+#include <string>
+#include <string_view>
+
+namespace report
+{
+
+/***
+    SVGBookmarkRewriter
+
+    Graphviz writes the ID of a bookmarked table cell as id="a_<bookmark>" on the group
+    around the cell's link where it does not work as a bookmark.  The rewriter moves each
+    such id, without the a_ prefix, onto the first <text> element that follows.
+
+    It works in a single forward pass over svg written to it in chunks of any size,
+    appending to strOutput as it goes.  Only a partially matched tag is held back between
+    writes.  finish() must be called after the last write.
+*/
+class SVGBookmarkRewriter
+{
+public:
+    explicit SVGBookmarkRewriter( std::string& strOutput )
+        : m_strOutput( strOutput )
+    {
+    }
+
+    void write( std::string_view str );
+    void finish();
+
+private:
+    enum State
+    {
+        eFindGroup, // copying up to the next <g id="a_
+        eReadID,    // reading the bookmark up to its closing quote
+        eFindText   // copying up to the <text that gets the bookmark
+    };
+
+    std::string& m_strOutput;
+    State        m_state     = eFindGroup;
+    std::size_t  m_szMatched = 0U;
+    std::string  m_strID;
+};
+
+// Appends strSVG to strOutput with the graphviz bookmark ids moved as above
+void rewriteSVGBookmarks( std::string_view strSVG, std::string& strOutput );
+
+} // namespace report
+
+#endif // GUARD_2024_April_12_svg_bookmarks
@@ -0,0 +1,39 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_April_02_svg_plot
+#define GUARD_2024_April_02_svg_plot
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+
+namespace report
+{
+
+// Appends a standalone svg chart for the plot data given to the plot template to strOutput.
+// The chart has the same size and axis labels as the default gnuplot template with the
+// title from the headings, a bar, line or scatter series from the first two columns of each
+// point and a hover label from the optional third column.  Values are already html escaped.
+// Non numeric x values are replaced by the point index and points without a numeric y are skipped.
+void renderSVGPlot( const nlohmann::json& data, std::string& strOutput );
+
+} // namespace report
+
+#endif // GUARD_2024_April_02_svg_plot
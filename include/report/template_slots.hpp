@@ -0,0 +1,77 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_20_template_slots
+#define GUARD_2024_March_20_template_slots
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace report
+{
+
+/***
+    TemplateSlots
+
+    Child containers of a Branch, Table or the Report body are passed to their template
+    as slot placeholders rather than as pre-rendered strings.  When the template prints
+    a placeholder the slot content is written directly to the template's output stream
+    so each byte of the report is only written once.
+*/
+class TemplateSlots
+{
+public:
+    static inline nlohmann::json placeholder( std::size_t szSlot )
+    {
+        std::vector< std::uint8_t > bytes( sizeof( std::uint64_t ) );
+        for( std::size_t i = 0U; i != bytes.size(); ++i )
+        {
+            bytes[ i ] = static_cast< std::uint8_t >( static_cast< std::uint64_t >( szSlot ) >> ( i * 8U ) );
+        }
+        return nlohmann::json::binary( std::move( bytes ) );
+    }
+
+    static inline std::optional< std::size_t > slot( const nlohmann::json& value )
+    {
+        if( value.is_binary() )
+        {
+            const auto&   bytes  = value.get_binary();
+            std::uint64_t szSlot = 0U;
+            for( std::size_t i = 0U; i != bytes.size() && i != sizeof( std::uint64_t ); ++i )
+            {
+                szSlot |= static_cast< std::uint64_t >( bytes[ i ] ) << ( i * 8U );
+            }
+            return static_cast< std::size_t >( szSlot );
+        }
+        return {};
+    }
+
+    virtual void write( std::size_t szSlot, std::ostream& os ) = 0;
+
+protected:
+    ~TemplateSlots() = default;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_20_template_slots
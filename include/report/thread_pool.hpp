@@ -0,0 +1,109 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_25_thread_pool
+#define GUARD_2024_March_25_thread_pool
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace report
+{
+
+/***
+    ThreadPool
+
+    Work stealing thread pool for fork / join rendering.  Each worker owns a task
+    queue which it pops LIFO while idle workers steal FIFO from the others.  Tasks
+    submitted from outside the pool go to a shared queue.
+
+    TaskGroup::wait executes pending tasks while it waits so nested groups can be
+    waited on from inside a task without starving the pool.
+*/
+class ThreadPool
+{
+public:
+    using Task = std::function< void() >;
+
+    // szThreads of zero uses std::thread::hardware_concurrency
+    explicit ThreadPool( std::size_t szThreads = 0U );
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool& )            = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+
+    std::size_t size() const { return m_threads.size(); }
+
+    class TaskGroup
+    {
+    public:
+        TaskGroup( ThreadPool& pool )
+            : m_pool( pool )
+        {
+        }
+        ~TaskGroup();
+
+        TaskGroup( const TaskGroup& )            = delete;
+        TaskGroup& operator=( const TaskGroup& ) = delete;
+
+        void run( Task task );
+
+        // waits for all tasks run so far and rethrows the first exception any of them threw
+        void wait();
+
+    private:
+        void waitAll();
+
+        ThreadPool&             m_pool;
+        std::mutex              m_mutex;
+        std::condition_variable m_condition;
+        std::size_t             m_szPending = 0U;
+        std::exception_ptr      m_pException;
+    };
+
+private:
+    struct Queue
+    {
+        std::mutex         mutex;
+        std::deque< Task > tasks;
+    };
+
+    void push( Task task );
+    bool runOne();
+    void worker( std::size_t szIndex );
+
+    // one queue per worker plus the shared queue at the back
+    std::vector< std::unique_ptr< Queue > > m_queues;
+    std::vector< std::thread >              m_threads;
+    std::atomic< std::size_t >              m_szQueued{ 0U };
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_condition;
+    bool                                    m_bStop = false;
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_25_thread_pool
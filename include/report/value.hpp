@@ -22,9 +22,13 @@
 #define GUARD_2024_March_08_value
 
 #include <variant>
+#include <charconv>
 #include <string>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
 #include <memory>
+#include <memory_resource>
 #include <vector>
 
 namespace report
@@ -32,17 +36,90 @@ namespace report
 
 // using Value = std::variant< int, std::string >;
 
+// Customization point for formatting the alternatives of a Value.  format returns the text of
+// value which is either written to strBuffer or, for strings, refers to value itself.  The default
+// uses operator<<.  Specialise for a user type to format it without a stream.
+template< typename T, typename Enable = void >
+struct ValueFormatter
+{
+    static std::string_view format( const T& value, std::string& strBuffer )
+    {
+        std::ostringstream osValue;
+        osValue << value;
+        strBuffer = osValue.str();
+        return strBuffer;
+    }
+};
+
+// strings are passed through without copying
+template< typename T >
+struct ValueFormatter< T, std::enable_if_t< std::is_convertible_v< const T&, std::string_view > > >
+{
+    static std::string_view format( const T& value, std::string& ) { return value; }
+};
+
+// numbers use std::to_chars which never allocates and formats floating point values with the
+// shortest text that reads back exactly.  bool and character types keep operator<<
+template< typename T >
+struct ValueFormatter< T,
+                       std::enable_if_t< std::is_arithmetic_v< T > && !std::is_same_v< T, bool >
+                                         && !std::is_same_v< T, char > && !std::is_same_v< T, signed char >
+                                         && !std::is_same_v< T, unsigned char > && !std::is_same_v< T, wchar_t >
+                                         && !std::is_same_v< T, char16_t > && !std::is_same_v< T, char32_t > > >
+{
+    static std::string_view format( T value, std::string& strBuffer )
+    {
+        // enough for any integer or the shortest round trip form of any double
+        static constexpr std::size_t szMaxLength = 32U;
+        strBuffer.resize( szMaxLength );
+        const auto result = std::to_chars( strBuffer.data(), strBuffer.data() + szMaxLength, value );
+        strBuffer.resize( static_cast< std::size_t >( result.ptr - strBuffer.data() ) );
+        return strBuffer;
+    }
+};
+
+// Returns the text of the current alternative of value.  strBuffer can be reused between calls
+// and the result is only valid until the next use of strBuffer or until value changes.
+template< typename Value >
+inline std::string_view formatValue( const Value& value, std::string& strBuffer )
+{
+    return std::visit(
+        [ &strBuffer ]( const auto& arg ) -> std::string_view
+        { return ValueFormatter< std::decay_t< decltype( arg ) > >::format( arg, strBuffer ); },
+        value );
+}
+
 template< typename Value >
 inline std::string toString( const Value& value )
 {
-    std::ostringstream osValue;
-    std::visit( [ & ]( const auto& arg ) { osValue << arg; }, value );
-    return osValue.str();
+    std::string            strBuffer;
+    const std::string_view strValue = formatValue( value, strBuffer );
+    return ( strValue.data() == strBuffer.data() ) ? strBuffer : std::string( strValue );
 }
 
+// Selects the vector used for every sequence in a report tree of Value.  The default is
+// std::vector.  Specialise ContainerTraits for a Value as PMRContainerTraits to build whole
+// reports in a std::pmr memory resource, such as a monotonic_buffer_resource which releases
+// the entire report at once.  Vectors keep their resource when moved but copies use the
+// default resource, so build the tree by moving or with the arena set as the default resource.
+template< typename Value >
+struct ContainerTraits
+{
+    template< typename T >
+    using Vector = std::vector< T >;
+};
+
+struct PMRContainerTraits
+{
+    template< typename T >
+    using Vector = std::pmr::vector< T >;
+};
+
+template< typename Value, typename T >
+using ReportVector = typename ContainerTraits< Value >::template Vector< T >;
 
 template< typename Value >
-using ValueVector = std::vector< Value >;
+using ValueVector = ReportVector< Value, Value >;
 
 }
 
@@ -146,6 +146,7 @@ int main( int argc, const char* argv[] )
 
     std::string                dataDirectory, repoDirectory, outputJSONFile, outputHTMLFile;
     std::vector< std::string > benchmarkDataFiles;
+    bool                       bNativePlots = false;
 
     {
         bool bShowHelp = false;
@@ -163,6 +164,7 @@ int main( int argc, const char* argv[] )
         ( "repo",       po::value< std::string >( &repoDirectory ),                       "Performance data git repository" )
         
         ( "output",     po::value< std::string >( &outputHTMLFile ),                      "Output html file" )
+        ( "native",     po::bool_switch( &bNativePlots ),                                 "Generate plots without gnuplot" )
 
         ( "files",      po::value< std::vector< std::string > >( &benchmarkDataFiles ),   "Google benchmark files" )
         ;
@@ -245,8 +247,18 @@ int main( int argc, const char* argv[] )
             // render the html report
             {
                 const auto report = makeSummaryReport( results );
-                auto       pFile  = boost::filesystem::createNewFileStream( outputHTMLFilePath );
-                report::renderHTML( report, *pFile );
+                if( outputHTMLFilePath.has_parent_path() )
+                {
+                    boost::filesystem::create_directories( outputHTMLFilePath.parent_path() );
+                }
+                report::FileSink file( outputHTMLFilePath );
+
+                report::HTMLTemplateEngine engine{ false };
+                if( bNativePlots )
+                {
+                    engine.setPlotBackend( report::HTMLTemplateEngine::eNativePlot );
+                }
+                report::renderHTML( report, file, engine );
             }
         }
     }
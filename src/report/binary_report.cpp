@@ -0,0 +1,107 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/binary_report.hpp"
+
+#include <array>
+
+namespace report
+{
+namespace
+{
+static constexpr std::array< char, 8 > g_magic         = { 'R', 'E', 'P', 'O', 'R', 'T', 'B', '\0' };
+static constexpr std::uint32_t         g_uiVersion     = 1U;
+static constexpr std::uint32_t         g_uiByteOrder   = 0x01020304U;
+static constexpr std::size_t           g_szHeaderSize  = g_magic.size() + sizeof( std::uint32_t ) * 2U;
+static constexpr std::size_t           g_szTrailerSize = sizeof( std::uint64_t ) + g_magic.size();
+
+template < typename T >
+inline T readAt( const char* pData )
+{
+    T value;
+    std::memcpy( &value, pData, sizeof( T ) );
+    return value;
+}
+} // namespace
+
+BinaryReportWriter::BinaryReportWriter( std::ostream& os )
+    : m_os( os )
+{
+    std::string    strHeader;
+    BinaryOArchive archive( strHeader );
+    archive.saveBytes( g_magic.data(), g_magic.size() );
+    archive& g_uiVersion;
+    archive& g_uiByteOrder;
+    append( strHeader );
+}
+
+std::uint64_t BinaryReportWriter::append( std::string_view strRecord )
+{
+    const std::uint64_t uiOffset = m_uiOffset;
+    m_os.write( strRecord.data(), static_cast< std::streamsize >( strRecord.size() ) );
+    m_uiOffset += strRecord.size();
+    return uiOffset;
+}
+
+void BinaryReportWriter::finish( std::uint64_t uiRootOffset )
+{
+    std::string    strTrailer;
+    BinaryOArchive archive( strTrailer );
+    archive& uiRootOffset;
+    archive.saveBytes( g_magic.data(), g_magic.size() );
+    append( strTrailer );
+    m_os.flush();
+    VERIFY_RTE_MSG( m_os.good(), "Failed to write binary report" );
+}
+
+MappedBinaryReport::MappedBinaryReport( const boost::filesystem::path& filePath )
+{
+    try
+    {
+        m_file.open( filePath.string() );
+    }
+    catch( std::exception& ex )
+    {
+        THROW_RTE( "Failed to open binary report: " << filePath.string() << " : " << ex.what() );
+    }
+
+    const char*       pData  = m_file.data();
+    const std::size_t szSize = m_file.size();
+    VERIFY_RTE_MSG( szSize >= g_szHeaderSize + g_szTrailerSize, "Not a binary report: " << filePath.string() );
+    VERIFY_RTE_MSG( std::memcmp( pData, g_magic.data(), g_magic.size() ) == 0
+                        && std::memcmp( pData + szSize - g_magic.size(), g_magic.data(), g_magic.size() ) == 0,
+                    "Not a binary report: " << filePath.string() );
+    VERIFY_RTE_MSG( readAt< std::uint32_t >( pData + g_magic.size() ) == g_uiVersion,
+                    "Unsupported binary report version: " << filePath.string() );
+    VERIFY_RTE_MSG( readAt< std::uint32_t >( pData + g_magic.size() + sizeof( std::uint32_t ) ) == g_uiByteOrder,
+                    "Binary report was written with a different byte order: " << filePath.string() );
+
+    m_records      = std::string_view( pData, szSize - g_szTrailerSize );
+    m_uiRootOffset = readAt< std::uint64_t >( pData + m_records.size() );
+    record( m_uiRootOffset );
+}
+
+std::string_view MappedBinaryReport::record( std::uint64_t uiOffset ) const
+{
+    VERIFY_RTE_MSG( ( uiOffset >= g_szHeaderSize ) && ( uiOffset < m_records.size() ),
+                    "Invalid record offset in binary report: " << uiOffset );
+    return m_records.substr( static_cast< std::size_t >( uiOffset ) );
+}
+
+} // namespace report
@@ -0,0 +1,200 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/content_cache.hpp"
+
+#include "common/assert_verify.hpp"
+#include "common/file.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+#include <tuple>
+#include <vector>
+
+namespace report
+{
+namespace
+{
+// keys become file names
+inline bool isValidKey( const std::string& strKey )
+{
+    const auto isAlphaNumeric = []( char c ) { return std::isalnum( static_cast< unsigned char >( c ) ) != 0; };
+    return !strKey.empty() && std::all_of( strKey.begin(), strKey.end(), isAlphaNumeric );
+}
+
+// temporary files older than this were left by a store that was interrupted rather than one in progress
+static const std::time_t g_staleTempSeconds = 10 * 60;
+
+} // namespace
+
+ContentCache::ContentCache( const boost::filesystem::path& directory, std::uint64_t uiMaxBytes,
+                            const std::string& strExtension )
+    : m_directory( directory )
+    , m_uiMaxBytes( uiMaxBytes )
+    , m_strExtension( strExtension )
+{
+    boost::filesystem::create_directories( m_directory );
+    VERIFY_RTE_MSG(
+        boost::filesystem::exists( m_directory ), "Failed to create cache folder: " << m_directory.string() );
+
+    // recover the lru order of existing entries from their modification times
+    std::vector< std::tuple< std::time_t, std::string, std::uint64_t > > existing;
+    std::vector< boost::filesystem::path >                               staleTemps;
+    const std::time_t                                                    now = std::time( nullptr );
+    for( const auto& entry : boost::filesystem::directory_iterator( m_directory ) )
+    {
+        const boost::filesystem::path& filePath = entry.path();
+        if( !boost::filesystem::is_regular_file( filePath ) )
+        {
+            continue;
+        }
+        if( filePath.extension() == m_strExtension )
+        {
+            existing.emplace_back( boost::filesystem::last_write_time( filePath ), filePath.stem().string(),
+                                   boost::filesystem::file_size( filePath ) );
+        }
+        else if( ( filePath.extension() == ".tmp" )
+                 && ( boost::filesystem::last_write_time( filePath ) + g_staleTempSeconds < now ) )
+        {
+            staleTemps.push_back( filePath );
+        }
+    }
+    for( const boost::filesystem::path& tempPath : staleTemps )
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove( tempPath, ec );
+    }
+    std::sort( existing.begin(), existing.end(),
+               []( const auto& left, const auto& right ) { return std::get< 0 >( left ) > std::get< 0 >( right ); } );
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    for( const auto& [ time, strKey, uiSize ] : existing )
+    {
+        m_entries.push_back( Entry{ strKey, uiSize } );
+        m_index.insert( { strKey, std::prev( m_entries.end() ) } );
+        m_uiTotalBytes += uiSize;
+    }
+    evict();
+}
+
+boost::filesystem::path ContentCache::entryPath( const std::string& strKey ) const
+{
+    return m_directory / ( strKey + m_strExtension );
+}
+
+void ContentCache::evict()
+{
+    // NOTE: always keep the most recent entry even if it alone exceeds the limit
+    while( ( m_uiTotalBytes > m_uiMaxBytes ) && ( m_entries.size() > 1U ) )
+    {
+        const Entry& entry = m_entries.back();
+        boost::system::error_code ec;
+        boost::filesystem::remove( entryPath( entry.strKey ), ec );
+        m_uiTotalBytes -= entry.uiSize;
+        m_index.erase( entry.strKey );
+        m_entries.pop_back();
+        ++m_statistics.szEvictions;
+    }
+}
+
+std::optional< std::string > ContentCache::load( const std::string& strKey )
+{
+    // NOTE: only the lru order is updated under the lock so that concurrent loads read their files in parallel
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        auto iFind = m_index.find( strKey );
+        if( iFind == m_index.end() )
+        {
+            ++m_statistics.szMisses;
+            return {};
+        }
+        m_entries.splice( m_entries.begin(), m_entries, iFind->second );
+        ++m_statistics.szHits;
+    }
+
+    const boost::filesystem::path filePath = entryPath( strKey );
+    std::string                   strContent;
+    try
+    {
+        boost::filesystem::loadAsciiFile( filePath, strContent );
+    }
+    catch( std::exception& )
+    {
+        // evicted meanwhile or removed by another process sharing the folder
+        std::lock_guard< std::mutex > lock( m_mutex );
+        --m_statistics.szHits;
+        ++m_statistics.szMisses;
+        auto iFind = m_index.find( strKey );
+        if( iFind != m_index.end() )
+        {
+            m_uiTotalBytes -= iFind->second->uiSize;
+            m_entries.erase( iFind->second );
+            m_index.erase( iFind );
+        }
+        return {};
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time( filePath, std::time( nullptr ), ec );
+    return strContent;
+}
+
+void ContentCache::store( const std::string& strKey, const std::string& strContent )
+{
+    VERIFY_RTE_MSG( isValidKey( strKey ), "Invalid cache key: " << strKey );
+
+    // write to a unique temporary file and rename so readers never see a partial entry
+    const boost::filesystem::path tempPath = m_directory / boost::filesystem::unique_path( "%%%%-%%%%-%%%%.tmp" );
+    {
+        auto pFile = boost::filesystem::createNewFileStream( tempPath );
+        *pFile << strContent;
+    }
+
+    std::lock_guard< std::mutex > lock( m_mutex );
+    if( m_index.count( strKey ) != 0U )
+    {
+        boost::system::error_code ec;
+        boost::filesystem::remove( tempPath, ec );
+        return;
+    }
+    boost::filesystem::rename( tempPath, entryPath( strKey ) );
+
+    m_entries.push_front( Entry{ strKey, strContent.size() } );
+    m_index.insert( { strKey, m_entries.begin() } );
+    m_uiTotalBytes += strContent.size();
+    evict();
+}
+
+ContentCache::Statistics ContentCache::getStatistics() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_statistics;
+}
+
+std::uint64_t ContentCache::getTotalBytes() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+    return m_uiTotalBytes;
+}
+
+} // namespace report
@@ -0,0 +1,180 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/deferred_output.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <chrono>
+#include <vector>
+
+namespace report
+{
+
+void DeferredOutput::append( const char* pData, std::size_t szSize )
+{
+    m_szWritten += szSize;
+    if( m_szWritten > m_szLimit )
+    {
+        m_bOverflowed = true;
+        THROW_RTE( "Deferred output limit of " << m_szLimit << " bytes exceeded" );
+    }
+
+    if( !m_segments.empty() )
+    {
+        m_segments.back().strText.append( pData, szSize );
+
+        // NOTE: text behind futures that have resolved since the last defer is not held until the next
+        m_szHeldBack += szSize;
+        if( m_pDestination && ( m_szHeldBack >= DRAIN_SIZE ) )
+        {
+            drain( false );
+        }
+    }
+    else if( m_pDestination )
+    {
+        m_pDestination->write( pData, szSize );
+    }
+    else
+    {
+        m_strHead.append( pData, szSize );
+    }
+}
+
+std::streamsize DeferredOutput::xsputn( const char* pData, std::streamsize szSize )
+{
+    append( pData, static_cast< std::size_t >( szSize ) );
+    return szSize;
+}
+
+DeferredOutput::int_type DeferredOutput::overflow( int_type ch )
+{
+    if( !traits_type::eq_int_type( ch, traits_type::eof() ) )
+    {
+        const char c = traits_type::to_char_type( ch );
+        append( &c, 1U );
+    }
+    return traits_type::not_eof( ch );
+}
+
+void DeferredOutput::drain( bool bRethrow )
+{
+    m_szHeldBack = 0U;
+    while( !m_segments.empty()
+           && m_segments.front().future.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+    {
+        Segment& segment = m_segments.front();
+        if( !bRethrow )
+        {
+            // a failed future is left for defer() or flush() to rethrow outside of the streambuf
+            // interface where the exception reaches the caller rather than just setting the badbit
+            try
+            {
+                segment.future.get();
+            }
+            catch( ... )
+            {
+                return;
+            }
+        }
+        const std::string& str = segment.future.get();
+        m_pDestination->write( str.data(), str.size() );
+        m_pDestination->write( segment.strText.data(), segment.strText.size() );
+        m_segments.pop_front();
+    }
+}
+
+void DeferredOutput::defer( Future future )
+{
+    m_segments.push_back( Segment{ std::move( future ), std::string{} } );
+    if( m_pDestination )
+    {
+        drain( true );
+    }
+}
+
+std::unique_ptr< DeferredOutput > DeferredOutput::createChild() const
+{
+    auto pChild     = std::make_unique< DeferredOutput >();
+    pChild->m_pRoot = m_pRoot;
+    return pChild;
+}
+
+void DeferredOutput::writeTo( std::ostream& os )
+{
+    VERIFY_RTE_MSG( !m_pDestination, "DeferredOutput with destination cannot be moved" );
+
+    if( DeferredOutput* pTarget = get( os ) )
+    {
+        pTarget->append( m_strHead.data(), m_strHead.size() );
+        for( auto& segment : m_segments )
+        {
+            pTarget->defer( std::move( segment.future ) );
+            pTarget->append( segment.strText.data(), segment.strText.size() );
+        }
+    }
+    else
+    {
+        os.write( m_strHead.data(), m_strHead.size() );
+        for( auto& segment : m_segments )
+        {
+            const std::string& str = segment.future.get();
+            os.write( str.data(), str.size() );
+            os.write( segment.strText.data(), segment.strText.size() );
+        }
+    }
+    m_strHead.clear();
+    m_segments.clear();
+}
+
+DeferredOutput::Future DeferredOutput::share() const
+{
+    VERIFY_RTE_MSG( !m_pDestination, "DeferredOutput with destination cannot be shared" );
+
+    std::vector< Segment > segments( m_segments.begin(), m_segments.end() );
+    return std::async( std::launch::deferred,
+                       [ strHead = m_strHead, segments = std::move( segments ) ]()
+                       {
+                           std::string str = strHead;
+                           for( const auto& segment : segments )
+                           {
+                               str.append( segment.future.get() );
+                               str.append( segment.strText );
+                           }
+                           return str;
+                       } )
+        .share();
+}
+
+void DeferredOutput::flush()
+{
+    VERIFY_RTE_MSG( m_pDestination, "DeferredOutput has no destination to flush to" );
+
+    while( !m_segments.empty() )
+    {
+        Segment&           segment = m_segments.front();
+        const std::string& str     = segment.future.get();
+        m_pDestination->write( str.data(), str.size() );
+        m_pDestination->write( segment.strText.data(), segment.strText.size() );
+        m_segments.pop_front();
+    }
+    m_pDestination->flush();
+}
+
+} // namespace report
@@ -0,0 +1,158 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/external_process.hpp"
+#include "process_pipes.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/process.hpp>
+
+#include <mutex>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <pthread.h>
+#endif
+
+namespace report
+{
+namespace bp = boost::process;
+
+namespace
+{
+std::mutex g_processStartMutex;
+
+#ifndef _WIN32
+inline void setCloseOnExec( int iHandle )
+{
+    const int iFlags = ::fcntl( iHandle, F_GETFD );
+    VERIFY_RTE_MSG( ( iFlags != -1 ) && ( ::fcntl( iHandle, F_SETFD, iFlags | FD_CLOEXEC ) != -1 ),
+                    "Failed to set close on exec for pipe" );
+}
+#endif
+
+} // namespace
+
+#ifndef _WIN32
+SigPipeGuard::SigPipeGuard()
+{
+    sigset_t sigPipe, pending;
+    sigemptyset( &sigPipe );
+    sigaddset( &sigPipe, SIGPIPE );
+    sigpending( &pending );
+    m_bWasPending = sigismember( &pending, SIGPIPE ) == 1;
+    pthread_sigmask( SIG_BLOCK, &sigPipe, &m_previous );
+}
+
+SigPipeGuard::~SigPipeGuard()
+{
+    // consume a SIGPIPE raised while blocked unless one was already pending for someone else
+    if( !m_bWasPending )
+    {
+        sigset_t sigPipe, pending;
+        sigemptyset( &sigPipe );
+        sigaddset( &sigPipe, SIGPIPE );
+        sigpending( &pending );
+        if( sigismember( &pending, SIGPIPE ) == 1 )
+        {
+            const timespec zero{ 0, 0 };
+            while( ( sigtimedwait( &sigPipe, nullptr, &zero ) == -1 ) && ( errno == EINTR ) )
+            {
+            }
+        }
+    }
+    pthread_sigmask( SIG_SETMASK, &m_previous, nullptr );
+}
+#else
+SigPipeGuard::SigPipeGuard()  = default;
+SigPipeGuard::~SigPipeGuard() = default;
+#endif
+
+std::unique_lock< std::mutex > lockProcessStart()
+{
+    return std::unique_lock< std::mutex >( g_processStartMutex );
+}
+
+boost::process::async_pipe createPipe( boost::asio::io_context& ioContext )
+{
+    boost::process::async_pipe pipe( ioContext );
+#ifndef _WIN32
+    setCloseOnExec( pipe.native_source() );
+    setCloseOnExec( pipe.native_sink() );
+#endif
+    return pipe;
+}
+
+ProcessResult runExternalProcess( const std::string& strProgram, const std::vector< std::string >& arguments,
+                                  const std::string& strInput, std::chrono::milliseconds timeout )
+{
+    const boost::filesystem::path programPath = bp::search_path( strProgram );
+    VERIFY_RTE_MSG( !programPath.empty(), "Failed to locate program: " << strProgram );
+
+    boost::asio::io_context ioContext;
+    ProcessResult           result;
+
+    std::unique_lock< std::mutex > lock       = lockProcessStart();
+    bp::async_pipe                 inputPipe  = createPipe( ioContext );
+    bp::async_pipe                 outputPipe = createPipe( ioContext );
+    bp::async_pipe                 errorPipe  = createPipe( ioContext );
+    bp::child                      child( programPath, bp::args( arguments ), bp::std_in < inputPipe,
+                                          bp::std_out > outputPipe, bp::std_err > errorPipe, ioContext );
+    lock.unlock();
+
+    // the input is written while the output is read so neither can fill its pipe and block the other.
+    // NOTE: asio may write immediately when the write is started so the guard must already be in place
+    SigPipeGuard sigPipeGuard;
+    boost::asio::async_write( inputPipe, boost::asio::buffer( strInput ),
+                              [ &inputPipe ]( const boost::system::error_code&, std::size_t )
+                              {
+                                  boost::system::error_code ec;
+                                  inputPipe.close( ec );
+                              } );
+    const auto ignoreEndOfFile = []( const boost::system::error_code&, std::size_t ) {};
+    boost::asio::async_read( outputPipe, boost::asio::dynamic_buffer( result.strOutput ), ignoreEndOfFile );
+    boost::asio::async_read( errorPipe, boost::asio::dynamic_buffer( result.strError ), ignoreEndOfFile );
+
+    // the io context runs until the pipes are closed and the process has exited
+    if( timeout.count() > 0 )
+    {
+        ioContext.run_for( timeout );
+        if( !ioContext.stopped() )
+        {
+            std::error_code ec;
+            child.terminate( ec );
+            THROW_RTE( strProgram << " timed out after " << timeout.count() << "ms" );
+        }
+    }
+    else
+    {
+        ioContext.run();
+    }
+    child.wait();
+
+    result.iExitCode = child.exit_code();
+    return result;
+}
+
+} // namespace report
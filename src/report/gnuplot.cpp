@@ -0,0 +1,186 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/gnuplot.hpp"
+#include "process_pipes.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <boost/asio/buffers_iterator.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/read_until.hpp>
+#include <boost/asio/streambuf.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/process.hpp>
+
+#include <array>
+
+namespace report
+{
+
+struct GNUPlot::Process
+{
+    boost::asio::io_context    ioContext;
+    boost::process::async_pipe inputPipe;
+    boost::process::async_pipe outputPipe;
+    boost::process::async_pipe errorPipe;
+    boost::asio::streambuf     outputBuffer;
+    std::array< char, 1024 >   errorChunk;
+    std::string                strError;
+    bool                       bErrorClosed = false;
+    boost::process::child      child;
+
+    // NOTE: the process start lock is taken before the pipes are created and released once started
+    Process( std::unique_lock< std::mutex > lock = lockProcessStart() )
+        : inputPipe( createPipe( ioContext ) )
+        , outputPipe( createPipe( ioContext ) )
+        , errorPipe( createPipe( ioContext ) )
+    {
+        namespace bp = boost::process;
+
+        const boost::filesystem::path programPath = bp::search_path( "gnuplot" );
+        VERIFY_RTE_MSG( !programPath.empty(), "Failed to locate program: gnuplot" );
+
+        child = bp::child( programPath, bp::std_in < inputPipe, bp::std_out > outputPipe, bp::std_err > errorPipe );
+        lock.unlock();
+        readError();
+    }
+
+    ~Process()
+    {
+        std::error_code ec;
+        if( child.running( ec ) )
+        {
+            boost::system::error_code closeError;
+            inputPipe.close( closeError );
+            if( !child.wait_for( std::chrono::seconds( 1 ), ec ) )
+            {
+                child.terminate( ec );
+            }
+        }
+    }
+
+    // stderr is drained continuously whenever the io context runs so gnuplot never blocks on it
+    void readError()
+    {
+        errorPipe.async_read_some( boost::asio::buffer( errorChunk ),
+                                   [ this ]( const boost::system::error_code& error, std::size_t szBytes )
+                                   {
+                                       strError.append( errorChunk.data(), szBytes );
+                                       if( !error )
+                                       {
+                                           readError();
+                                       }
+                                       else
+                                       {
+                                           bErrorClosed = true;
+                                       }
+                                   } );
+    }
+};
+
+GNUPlot::GNUPlot() = default;
+
+GNUPlot::~GNUPlot() = default;
+
+std::string GNUPlot::run( const std::string& strScript, std::chrono::milliseconds timeout )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    std::error_code ec;
+    if( !m_pProcess || !m_pProcess->child.running( ec ) )
+    {
+        m_pProcess = std::make_unique< Process >();
+    }
+    Process& process = *m_pProcess;
+
+    // NOTE: closing the output flushes the svg to stdout which the marker then follows.  The marker is
+    // printed to stderr as well since the two pipes are not ordered relative to each other.  The script
+    // is written while the output is read so that neither can fill its pipe and block the other.
+    const std::string strMarker = "report_gnuplot_complete_" + std::to_string( ++m_szScripts ) + "\n";
+    const std::string strPrint  = "print \"" + strMarker.substr( 0U, strMarker.size() - 1U ) + "\"\n";
+    const std::string strInput
+        = "reset\n" + strScript + "\nset output\nset print \"-\"\n" + strPrint + "set print\n" + strPrint;
+    SigPipeGuard      sigPipeGuard;
+    boost::asio::async_write( process.inputPipe, boost::asio::buffer( strInput ),
+                              []( const boost::system::error_code&, std::size_t ) {} );
+
+    // read the svg up to the marker on stdout.  If gnuplot exits on an error the read fails.
+    bool                      bComplete = false;
+    boost::system::error_code readError;
+    boost::asio::async_read_until( process.outputPipe, process.outputBuffer, strMarker,
+                                   [ &bComplete, &readError ]( const boost::system::error_code& error, std::size_t )
+                                   {
+                                       bComplete = true;
+                                       readError = error;
+                                   } );
+    // stderr is complete once it reaches the marker or closes when gnuplot exits
+    const auto errorComplete = [ &process, &strMarker ]()
+    { return process.bErrorClosed || ( process.strError.find( strMarker ) != std::string::npos ); };
+
+    process.ioContext.restart();
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while( !bComplete || !errorComplete() )
+    {
+        const std::size_t szHandlers = ( timeout.count() > 0 ) ? process.ioContext.run_one_until( deadline )
+                                                                : process.ioContext.run_one();
+        if( szHandlers == 0U )
+        {
+            break;
+        }
+    }
+
+    if( !bComplete || !errorComplete() )
+    {
+        process.child.terminate( ec );
+        m_pProcess.reset();
+        THROW_RTE( "gnuplot timed out after " << timeout.count() << "ms" );
+    }
+
+    // take what gnuplot reported on stderr for this script only
+    std::string       strError;
+    const std::size_t szErrorMarker = process.strError.find( strMarker );
+    if( szErrorMarker != std::string::npos )
+    {
+        strError = process.strError.substr( 0U, szErrorMarker );
+        process.strError.erase( 0U, szErrorMarker + strMarker.size() );
+    }
+    else
+    {
+        std::swap( strError, process.strError );
+    }
+
+    if( readError )
+    {
+        // gnuplot exited before completing the script
+        m_pProcess.reset();
+        THROW_RTE( "gnuplot failed with error: " << strError );
+    }
+
+    // NOTE: the output is consumed before any warning is reported so that none is left for the next script
+    const auto  buffers = process.outputBuffer.data();
+    std::string strSVG( boost::asio::buffers_begin( buffers ), boost::asio::buffers_end( buffers ) );
+    process.outputBuffer.consume( process.outputBuffer.size() );
+    VERIFY_RTE_MSG( strError.empty(), "gnuplot failed with error: " << strError );
+
+    strSVG.erase( strSVG.find( strMarker ) );
+    return strSVG;
+}
+
+} // namespace report
@@ -0,0 +1,1069 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/graph_layout.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include <vector>
+
+namespace report
+{
+namespace
+{
+
+// approximates the monospace 10pt font and table cells of graph.jinja
+static const double      g_charWidth      = 6.0;
+static const double      g_rowHeight      = 14.0;
+static const double      g_textBaseline   = 10.5;
+static const double      g_cellPadding    = 4.0;
+static const double      g_minNodeSize    = 8.0;
+static const double      g_nodeSeparation = 20.0;
+static const double      g_rankSeparation = 40.0;
+static const double      g_dummyBreadth   = 4.0;
+static const double      g_clusterPadding = 8.0;
+static const double      g_selfLoopSize   = 24.0;
+static const double      g_arrowLength    = 8.0;
+static const double      g_arrowWidth     = 3.5;
+static const double      g_margin         = 4.0;
+static const int         g_orderingSweeps = 24;
+static const int         g_placingSweeps  = 8;
+static const std::size_t g_none           = std::numeric_limits< std::size_t >::max();
+
+struct Vec
+{
+    double x, y;
+};
+
+inline Vec operator+( Vec l, Vec r )
+{
+    return Vec{ l.x + r.x, l.y + r.y };
+}
+inline Vec operator-( Vec l, Vec r )
+{
+    return Vec{ l.x - r.x, l.y - r.y };
+}
+inline Vec operator*( Vec v, double d )
+{
+    return Vec{ v.x * d, v.y * d };
+}
+
+struct Box
+{
+    double minX = std::numeric_limits< double >::max(), minY = std::numeric_limits< double >::max();
+    double maxX = std::numeric_limits< double >::lowest(), maxY = std::numeric_limits< double >::lowest();
+
+    void add( Vec v )
+    {
+        minX = std::min( minX, v.x );
+        minY = std::min( minY, v.y );
+        maxX = std::max( maxX, v.x );
+        maxY = std::max( maxY, v.y );
+    }
+    void add( Vec centre, double width, double height )
+    {
+        add( Vec{ centre.x - width / 2.0, centre.y - height / 2.0 } );
+        add( Vec{ centre.x + width / 2.0, centre.y + height / 2.0 } );
+    }
+    bool   empty() const { return maxX < minX; }
+    double width() const { return maxX - minX; }
+    double height() const { return maxY - minY; }
+};
+
+void appendNumber( std::string& str, double value )
+{
+    char      buffer[ 32 ];
+    const int iLength = std::snprintf( buffer, sizeof( buffer ), "%.1f", value );
+    str.append( buffer, static_cast< std::size_t >( iLength ) );
+}
+
+void appendPoint( std::string& str, Vec v )
+{
+    appendNumber( str, v.x );
+    str.push_back( ',' );
+    appendNumber( str, v.y );
+}
+
+void appendAttribute( std::string& str, const char* pszName, double value )
+{
+    str.push_back( ' ' );
+    str.append( pszName );
+    str.append( "=\"" );
+    appendNumber( str, value );
+    str.push_back( '\"' );
+}
+
+void appendAttribute( std::string& str, const char* pszName, const std::string& strValue )
+{
+    str.push_back( ' ' );
+    str.append( pszName );
+    str.append( "=\"" );
+    str.append( strValue );
+    str.push_back( '\"' );
+}
+
+// text is already html escaped so each entity is one character and utf8 continuation bytes are skipped
+std::size_t displayLength( const std::string& str )
+{
+    std::size_t szLength = 0U;
+    for( auto i = str.begin(); i != str.end(); ++i )
+    {
+        const unsigned char c = static_cast< unsigned char >( *i );
+        if( c == '&' )
+        {
+            i = std::find( i, str.end(), ';' );
+            if( i == str.end() )
+            {
+                ++szLength;
+                break;
+            }
+        }
+        else if( ( c & 0xC0U ) == 0x80U )
+        {
+            continue;
+        }
+        ++szLength;
+    }
+    return szLength;
+}
+
+inline double cellWidth( const std::string& str )
+{
+    return static_cast< double >( displayLength( str ) ) * g_charWidth + g_cellPadding * 2.0;
+}
+
+// rows of table cells as given to the graph template
+struct Label
+{
+    std::vector< std::vector< const std::string* > > rows;
+    double                                           width = 0.0, height = 0.0;
+
+    bool empty() const { return rows.empty(); }
+};
+
+Label makeLabel( const nlohmann::json& rows )
+{
+    Label label;
+    for( const auto& row : rows )
+    {
+        auto&  cells    = label.rows.emplace_back();
+        double rowWidth = 0.0;
+        for( const auto& cell : row )
+        {
+            cells.push_back( &cell.get_ref< const std::string& >() );
+            rowWidth += cellWidth( *cells.back() );
+        }
+        label.width = std::max( label.width, rowWidth );
+    }
+    label.height = static_cast< double >( label.rows.size() ) * g_rowHeight;
+    return label;
+}
+
+// cells are widened evenly to fill the table width as graphviz does
+void appendLabel( std::string& str, const Label& label, Vec topLeft, double width, const std::string& strColour,
+                  const std::string* pBookmark = nullptr, const std::string* pBookmarkHREF = nullptr )
+{
+    double y = topLeft.y;
+    for( const auto& cells : label.rows )
+    {
+        double rowWidth = 0.0;
+        for( const std::string* pCell : cells )
+        {
+            rowWidth += cellWidth( *pCell );
+        }
+        const double extra = cells.empty() ? 0.0 : ( width - rowWidth ) / static_cast< double >( cells.size() );
+
+        double x = topLeft.x;
+        for( const std::string* pCell : cells )
+        {
+            const double w = cellWidth( *pCell ) + extra;
+            str.append( "<rect" );
+            appendAttribute( str, "x", x );
+            appendAttribute( str, "y", y );
+            appendAttribute( str, "width", w );
+            appendAttribute( str, "height", g_rowHeight );
+            str.append( " fill=\"none\"" );
+            appendAttribute( str, "stroke", strColour );
+            str.append( "/>\n" );
+
+            if( pBookmark )
+            {
+                str.append( "<a" );
+                appendAttribute( str, "xlink:href", *pBookmarkHREF );
+                str.append( ">" );
+            }
+            str.append( "<text" );
+            if( pBookmark )
+            {
+                appendAttribute( str, "id", *pBookmark );
+            }
+            appendAttribute( str, "x", x + w / 2.0 );
+            appendAttribute( str, "y", y + g_textBaseline );
+            str.append( " text-anchor=\"middle\">" );
+            str.append( *pCell );
+            str.append( "</text>" );
+            if( pBookmark )
+            {
+                str.append( "</a>" );
+                pBookmark = nullptr;
+            }
+            str.push_back( '\n' );
+            x += w;
+        }
+        y += g_rowHeight;
+    }
+}
+
+// point where the line from the centre of the box towards target leaves the box
+Vec clip( Vec centre, double width, double height, Vec target )
+{
+    const Vec d = target - centre;
+    if( d.x == 0.0 && d.y == 0.0 )
+    {
+        return centre;
+    }
+    const double tx = ( d.x != 0.0 ) ? ( width / 2.0 ) / std::abs( d.x ) : std::numeric_limits< double >::max();
+    const double ty = ( d.y != 0.0 ) ? ( height / 2.0 ) / std::abs( d.y ) : std::numeric_limits< double >::max();
+    return centre + d * std::min( { tx, ty, 1.0 } );
+}
+
+struct Segment
+{
+    Vec c1, c2, end;
+};
+
+struct Path
+{
+    Vec                    start;
+    std::vector< Segment > segments;
+
+    void lineTo( Vec end )
+    {
+        const Vec from = segments.empty() ? start : segments.back().end;
+        segments.push_back( Segment{ from + ( end - from ) * ( 1.0 / 3.0 ), from + ( end - from ) * ( 2.0 / 3.0 ), end } );
+    }
+};
+
+class Layout
+{
+public:
+    Layout( const nlohmann::json& data );
+
+    void render( std::string& strOutput );
+
+private:
+    struct Node
+    {
+        std::size_t                szGraphNode = g_none; // g_none for the dummy nodes of long edges
+        int                        iCluster    = -1;
+        double                     breadth = g_dummyBreadth, depth = 0.0; // extent across and along the ranks
+        std::size_t                szRank = 0U, szOrder = 0U;
+        double                     position = 0.0; // centre across the ranks
+        std::vector< std::size_t > above, below;
+    };
+
+    // the layout nodes an edge passes through from its tail to its head
+    struct Route
+    {
+        std::size_t                szEdge;
+        bool                       bReversed;
+        std::vector< std::size_t > chain;
+    };
+
+    const nlohmann::json& m_data;
+    bool                  m_bHorizontal = false, m_bFlipped = false;
+    std::size_t           m_szClusters = 0U;
+
+    std::vector< Label >                      m_labels;
+    std::vector< double >                     m_widths, m_heights;
+    std::vector< Node >                       m_nodes;
+    std::vector< Route >                      m_routes;
+    std::vector< bool >                       m_routed;
+    std::vector< std::vector< std::size_t > > m_ranks;
+    std::vector< double >                     m_rankCentres;
+
+    void        rank( std::vector< std::pair< std::size_t, std::size_t > >& constraints );
+    void        order();
+    void        orderRank( std::size_t szRank, bool bDown );
+    std::size_t countCrossings() const;
+    void        place();
+    void        placeRank( std::size_t szRank, bool bAbove, bool bBelow );
+    Vec         centre( std::size_t szNode ) const;
+    bool        appendEdge( std::string& str, Box& box, const nlohmann::json& edge, Path& path ) const;
+};
+
+Layout::Layout( const nlohmann::json& data )
+    : m_data( data )
+{
+    const std::string& strDirection = data[ "rank_direction" ].get_ref< const std::string& >();
+    m_bHorizontal                   = ( strDirection == "LR" ) || ( strDirection == "RL" );
+    m_bFlipped                      = ( strDirection == "RL" ) || ( strDirection == "BT" );
+
+    const nlohmann::json& nodes = data[ "nodes" ];
+    for( const auto& node : nodes )
+    {
+        const double border = node[ "border_width" ].get< double >();
+        m_labels.push_back( makeLabel( node[ "text" ] ) );
+        m_widths.push_back( std::max( m_labels.back().width, g_minNodeSize ) + border * 2.0 );
+        m_heights.push_back( std::max( m_labels.back().height, g_minNodeSize ) + border * 2.0 );
+
+        Node layoutNode;
+        layoutNode.szGraphNode = m_nodes.size();
+        layoutNode.breadth     = m_bHorizontal ? m_heights.back() : m_widths.back();
+        layoutNode.depth       = m_bHorizontal ? m_widths.back() : m_heights.back();
+        m_nodes.push_back( layoutNode );
+    }
+
+    // a node belongs to the first subgraph listing it
+    for( const auto& subgraph : data[ "subgraphs" ] )
+    {
+        for( const auto& index : subgraph[ "node_indices" ] )
+        {
+            Node& node = m_nodes[ index.get< std::size_t >() ];
+            if( node.iCluster < 0 )
+            {
+                node.iCluster = static_cast< int >( m_szClusters );
+            }
+        }
+        ++m_szClusters;
+    }
+
+    std::vector< std::pair< std::size_t, std::size_t > > constraints;
+    const nlohmann::json&                                edges = data[ "edges" ];
+    m_routed.resize( edges.size(), false );
+    for( std::size_t szEdge = 0U; szEdge != edges.size(); ++szEdge )
+    {
+        const nlohmann::json& edge    = edges[ szEdge ];
+        const std::size_t     szFrom  = edge[ "source" ].get< std::size_t >();
+        const std::size_t     szTo    = edge[ "target" ].get< std::size_t >();
+        if( ( szFrom != szTo ) && ( edge[ "constraint" ].get_ref< const std::string& >() == "true" ) )
+        {
+            constraints.emplace_back( szFrom, szTo );
+            m_routes.push_back( Route{ szEdge, false, {} } );
+            m_routed[ szEdge ] = true;
+        }
+    }
+
+    rank( constraints );
+    order();
+    place();
+}
+
+void Layout::rank( std::vector< std::pair< std::size_t, std::size_t > >& constraints )
+{
+    const std::size_t szNodes = m_nodes.size();
+
+    // break cycles by reversing the edges a depth first search finds to lead back onto its stack
+    {
+        std::vector< std::vector< std::size_t > > outgoing( szNodes );
+        for( std::size_t szEdge = 0U; szEdge != constraints.size(); ++szEdge )
+        {
+            outgoing[ constraints[ szEdge ].first ].push_back( szEdge );
+        }
+
+        enum State
+        {
+            eUnvisited,
+            eOnStack,
+            eDone
+        };
+        std::vector< State >                                 states( szNodes, eUnvisited );
+        std::vector< std::pair< std::size_t, std::size_t > > stack;
+        for( std::size_t szRoot = 0U; szRoot != szNodes; ++szRoot )
+        {
+            if( states[ szRoot ] != eUnvisited )
+            {
+                continue;
+            }
+            states[ szRoot ] = eOnStack;
+            stack.emplace_back( szRoot, 0U );
+            while( !stack.empty() )
+            {
+                const auto [ szNode, szNext ] = stack.back();
+                if( szNext == outgoing[ szNode ].size() )
+                {
+                    states[ szNode ] = eDone;
+                    stack.pop_back();
+                    continue;
+                }
+                ++stack.back().second;
+
+                const std::size_t szEdge   = outgoing[ szNode ][ szNext ];
+                const std::size_t szTarget = constraints[ szEdge ].second;
+                if( states[ szTarget ] == eOnStack )
+                {
+                    m_routes[ szEdge ].bReversed = true;
+                }
+                else if( states[ szTarget ] == eUnvisited )
+                {
+                    states[ szTarget ] = eOnStack;
+                    stack.emplace_back( szTarget, 0U );
+                }
+            }
+        }
+        for( std::size_t szEdge = 0U; szEdge != constraints.size(); ++szEdge )
+        {
+            if( m_routes[ szEdge ].bReversed )
+            {
+                std::swap( constraints[ szEdge ].first, constraints[ szEdge ].second );
+            }
+        }
+    }
+
+    // longest path ranking in topological order
+    std::vector< std::vector< std::size_t > > successors( szNodes ), predecessors( szNodes );
+    for( const auto& [ szFrom, szTo ] : constraints )
+    {
+        successors[ szFrom ].push_back( szTo );
+        predecessors[ szTo ].push_back( szFrom );
+    }
+    std::vector< std::size_t > topological, inDegree( szNodes );
+    for( std::size_t szNode = 0U; szNode != szNodes; ++szNode )
+    {
+        inDegree[ szNode ] = predecessors[ szNode ].size();
+        if( inDegree[ szNode ] == 0U )
+        {
+            topological.push_back( szNode );
+        }
+    }
+    for( std::size_t szIndex = 0U; szIndex != topological.size(); ++szIndex )
+    {
+        const std::size_t szNode = topological[ szIndex ];
+        for( std::size_t szTo : successors[ szNode ] )
+        {
+            m_nodes[ szTo ].szRank = std::max( m_nodes[ szTo ].szRank, m_nodes[ szNode ].szRank + 1U );
+            if( --inDegree[ szTo ] == 0U )
+            {
+                topological.push_back( szTo );
+            }
+        }
+    }
+
+    // pull sources down next to their nearest successor so they do not drag long edges
+    for( auto i = topological.rbegin(); i != topological.rend(); ++i )
+    {
+        if( predecessors[ *i ].empty() && !successors[ *i ].empty() )
+        {
+            std::size_t szRank = std::numeric_limits< std::size_t >::max();
+            for( std::size_t szTo : successors[ *i ] )
+            {
+                szRank = std::min( szRank, m_nodes[ szTo ].szRank );
+            }
+            m_nodes[ *i ].szRank = szRank - 1U;
+        }
+    }
+
+    // long edges pass through a dummy node on each rank they cross
+    for( std::size_t szEdge = 0U; szEdge != constraints.size(); ++szEdge )
+    {
+        const auto [ szFrom, szTo ] = constraints[ szEdge ];
+        Route& route                = m_routes[ szEdge ];
+        route.chain.push_back( szFrom );
+        for( std::size_t szRank = m_nodes[ szFrom ].szRank + 1U; szRank < m_nodes[ szTo ].szRank; ++szRank )
+        {
+            Node dummy;
+            dummy.szRank = szRank;
+            route.chain.push_back( m_nodes.size() );
+            m_nodes.push_back( dummy );
+        }
+        route.chain.push_back( szTo );
+        for( std::size_t szLink = 1U; szLink != route.chain.size(); ++szLink )
+        {
+            m_nodes[ route.chain[ szLink - 1U ] ].below.push_back( route.chain[ szLink ] );
+            m_nodes[ route.chain[ szLink ] ].above.push_back( route.chain[ szLink - 1U ] );
+        }
+    }
+
+    for( std::size_t szNode = 0U; szNode != m_nodes.size(); ++szNode )
+    {
+        Node& node = m_nodes[ szNode ];
+        if( node.szRank >= m_ranks.size() )
+        {
+            m_ranks.resize( node.szRank + 1U );
+        }
+        node.szOrder = m_ranks[ node.szRank ].size();
+        m_ranks[ node.szRank ].push_back( szNode );
+    }
+}
+
+void Layout::orderRank( std::size_t szRank, bool bDown )
+{
+    std::vector< std::size_t >& nodes = m_ranks[ szRank ];
+
+    // barycenter of the neighbours in the rank just ordered otherwise the current order
+    std::vector< double > keys( m_nodes.size() );
+    for( std::size_t szNode : nodes )
+    {
+        const Node&                       node       = m_nodes[ szNode ];
+        const std::vector< std::size_t >& neighbours = bDown ? node.above : node.below;
+        double                            key        = static_cast< double >( node.szOrder );
+        if( !neighbours.empty() )
+        {
+            key = 0.0;
+            for( std::size_t szNeighbour : neighbours )
+            {
+                key += static_cast< double >( m_nodes[ szNeighbour ].szOrder );
+            }
+            key /= static_cast< double >( neighbours.size() );
+        }
+        keys[ szNode ] = key;
+    }
+
+    // the nodes of a subgraph share their mean key so they stay together
+    std::vector< std::pair< double, std::size_t > > clusters( m_szClusters, { 0.0, 0U } );
+    for( std::size_t szNode : nodes )
+    {
+        if( m_nodes[ szNode ].iCluster >= 0 )
+        {
+            auto& [ sum, szCount ] = clusters[ m_nodes[ szNode ].iCluster ];
+            sum += keys[ szNode ];
+            ++szCount;
+        }
+    }
+    const auto sortKey = [ & ]( std::size_t szNode )
+    {
+        const Node& node = m_nodes[ szNode ];
+        if( node.iCluster < 0 )
+        {
+            return std::make_tuple( keys[ szNode ], -1, keys[ szNode ], node.szOrder );
+        }
+        const auto& [ sum, szCount ] = clusters[ node.iCluster ];
+        return std::make_tuple( sum / static_cast< double >( szCount ), node.iCluster, keys[ szNode ], node.szOrder );
+    };
+    std::sort( nodes.begin(), nodes.end(),
+               [ & ]( std::size_t left, std::size_t right ) { return sortKey( left ) < sortKey( right ); } );
+
+    for( std::size_t szOrder = 0U; szOrder != nodes.size(); ++szOrder )
+    {
+        m_nodes[ nodes[ szOrder ] ].szOrder = szOrder;
+    }
+}
+
+std::size_t Layout::countCrossings() const
+{
+    std::size_t                                          szCrossings = 0U;
+    std::vector< std::pair< std::size_t, std::size_t > > links;
+    std::vector< std::size_t >                           tree;
+    for( std::size_t szRank = 0U; szRank + 1U < m_ranks.size(); ++szRank )
+    {
+        links.clear();
+        for( std::size_t szNode : m_ranks[ szRank ] )
+        {
+            for( std::size_t szBelow : m_nodes[ szNode ].below )
+            {
+                links.emplace_back( m_nodes[ szNode ].szOrder, m_nodes[ szBelow ].szOrder );
+            }
+        }
+        std::sort( links.begin(), links.end() );
+
+        // count the links already seen that end further along using a fenwick tree
+        const std::size_t szWidth = m_ranks[ szRank + 1U ].size();
+        tree.assign( szWidth + 1U, 0U );
+        for( std::size_t szLink = 0U; szLink != links.size(); ++szLink )
+        {
+            std::size_t szNotAfter = 0U;
+            for( std::size_t i = links[ szLink ].second + 1U; i > 0U; i -= i & ( ~i + 1U ) )
+            {
+                szNotAfter += tree[ i ];
+            }
+            szCrossings += szLink - szNotAfter;
+            for( std::size_t i = links[ szLink ].second + 1U; i <= szWidth; i += i & ( ~i + 1U ) )
+            {
+                ++tree[ i ];
+            }
+        }
+    }
+    return szCrossings;
+}
+
+void Layout::order()
+{
+    std::vector< std::size_t > best( m_nodes.size() );
+    const auto                 save = [ & ]()
+    {
+        for( std::size_t szNode = 0U; szNode != m_nodes.size(); ++szNode )
+        {
+            best[ szNode ] = m_nodes[ szNode ].szOrder;
+        }
+    };
+    save();
+
+    std::size_t szBest = countCrossings();
+    for( int iSweep = 0; ( iSweep != g_orderingSweeps ) && ( szBest != 0U ); ++iSweep )
+    {
+        if( iSweep % 2 == 0 )
+        {
+            for( std::size_t szRank = 1U; szRank < m_ranks.size(); ++szRank )
+            {
+                orderRank( szRank, true );
+            }
+        }
+        else
+        {
+            for( std::size_t szRank = m_ranks.size(); szRank-- > 0U; )
+            {
+                orderRank( szRank, false );
+            }
+        }
+        const std::size_t szCrossings = countCrossings();
+        if( szCrossings < szBest )
+        {
+            szBest = szCrossings;
+            save();
+        }
+    }
+
+    for( std::size_t szNode = 0U; szNode != m_nodes.size(); ++szNode )
+    {
+        m_nodes[ szNode ].szOrder = best[ szNode ];
+    }
+    for( auto& nodes : m_ranks )
+    {
+        std::sort( nodes.begin(), nodes.end(),
+                   [ & ]( std::size_t l, std::size_t r ) { return m_nodes[ l ].szOrder < m_nodes[ r ].szOrder; } );
+    }
+}
+
+// moves each node towards the mean position of its neighbours keeping the order and separation
+// of the rank.  Pooling adjacent violators gives the least squares placement for the order.
+void Layout::placeRank( std::size_t szRank, bool bAbove, bool bBelow )
+{
+    const std::vector< std::size_t >& nodes = m_ranks[ szRank ];
+
+    std::vector< double > offsets( nodes.size(), 0.0 ), desired( nodes.size() );
+    for( std::size_t szIndex = 0U; szIndex != nodes.size(); ++szIndex )
+    {
+        const Node& node = m_nodes[ nodes[ szIndex ] ];
+        if( szIndex != 0U )
+        {
+            const Node& previous = m_nodes[ nodes[ szIndex - 1U ] ];
+            offsets[ szIndex ]   = offsets[ szIndex - 1U ] + ( previous.breadth + node.breadth ) / 2.0 + g_nodeSeparation;
+        }
+
+        double      sum     = 0.0;
+        std::size_t szCount = 0U;
+        for( const auto* pNeighbours : { bAbove ? &node.above : nullptr, bBelow ? &node.below : nullptr } )
+        {
+            if( pNeighbours )
+            {
+                for( std::size_t szNeighbour : *pNeighbours )
+                {
+                    sum += m_nodes[ szNeighbour ].position;
+                    ++szCount;
+                }
+            }
+        }
+        desired[ szIndex ] = ( szCount != 0U ) ? sum / static_cast< double >( szCount ) : node.position;
+    }
+
+    struct Block
+    {
+        double      sum;
+        std::size_t szCount;
+        double      value() const { return sum / static_cast< double >( szCount ); }
+    };
+    std::vector< Block > blocks;
+    for( std::size_t szIndex = 0U; szIndex != nodes.size(); ++szIndex )
+    {
+        blocks.push_back( Block{ desired[ szIndex ] - offsets[ szIndex ], 1U } );
+        while( ( blocks.size() > 1U ) && ( blocks[ blocks.size() - 2U ].value() > blocks.back().value() ) )
+        {
+            blocks[ blocks.size() - 2U ].sum += blocks.back().sum;
+            blocks[ blocks.size() - 2U ].szCount += blocks.back().szCount;
+            blocks.pop_back();
+        }
+    }
+    std::size_t szIndex = 0U;
+    for( const Block& block : blocks )
+    {
+        for( std::size_t szBlock = 0U; szBlock != block.szCount; ++szBlock, ++szIndex )
+        {
+            m_nodes[ nodes[ szIndex ] ].position = block.value() + offsets[ szIndex ];
+        }
+    }
+}
+
+void Layout::place()
+{
+    for( const auto& nodes : m_ranks )
+    {
+        double position = 0.0;
+        for( std::size_t szNode : nodes )
+        {
+            Node& node    = m_nodes[ szNode ];
+            node.position = position + node.breadth / 2.0;
+            position += node.breadth + g_nodeSeparation;
+        }
+    }
+    for( int iSweep = 0; iSweep != g_placingSweeps; ++iSweep )
+    {
+        for( std::size_t szRank = 1U; szRank < m_ranks.size(); ++szRank )
+        {
+            placeRank( szRank, true, false );
+        }
+        for( std::size_t szRank = m_ranks.size(); szRank-- > 0U; )
+        {
+            placeRank( szRank, false, true );
+        }
+    }
+    for( std::size_t szRank = 0U; szRank != m_ranks.size(); ++szRank )
+    {
+        placeRank( szRank, true, true );
+    }
+
+    double rankStart = 0.0;
+    for( const auto& nodes : m_ranks )
+    {
+        double depth = 0.0;
+        for( std::size_t szNode : nodes )
+        {
+            depth = std::max( depth, m_nodes[ szNode ].depth );
+        }
+        m_rankCentres.push_back( rankStart + depth / 2.0 );
+        rankStart += depth + g_rankSeparation;
+    }
+}
+
+Vec Layout::centre( std::size_t szNode ) const
+{
+    const Node&  node  = m_nodes[ szNode ];
+    const double along = m_bFlipped ? -m_rankCentres[ node.szRank ] : m_rankCentres[ node.szRank ];
+    return m_bHorizontal ? Vec{ along, node.position } : Vec{ node.position, along };
+}
+
+// the path ends at the base of the arrow head in the direction it arrives from.  Returns false for invisible edges.
+bool Layout::appendEdge( std::string& str, Box& box, const nlohmann::json& edge, Path& path ) const
+{
+    const std::string& strStyle = edge[ "style" ].get_ref< const std::string& >();
+    if( strStyle == "invis" )
+    {
+        return false;
+    }
+    const std::string& strColour = edge[ "colour" ].get_ref< const std::string& >();
+    double             width     = edge[ "line_width" ].get< double >();
+    if( strStyle == "bold" )
+    {
+        width *= 2.0;
+    }
+
+    Segment&     last   = path.segments.back();
+    const Vec    tip    = last.end;
+    const Vec    before = path.segments.size() > 1U ? path.segments[ path.segments.size() - 2U ].end : path.start;
+    Vec          along  = tip - last.c2;
+    double       length = std::hypot( along.x, along.y );
+    if( length < 1e-6 )
+    {
+        along  = tip - before;
+        length = std::hypot( along.x, along.y );
+    }
+    const Vec direction = ( length < 1e-6 ) ? Vec{ 1.0, 0.0 } : along * ( 1.0 / length );
+    const Vec base      = tip - direction * g_arrowLength;
+    last.end            = base;
+
+    str.append( "<path" );
+    appendAttribute( str, "stroke", strColour );
+    appendAttribute( str, "stroke-width", width );
+    if( strStyle == "dashed" )
+    {
+        str.append( " stroke-dasharray=\"5,2\"" );
+    }
+    else if( strStyle == "dotted" )
+    {
+        str.append( " stroke-dasharray=\"1,5\"" );
+    }
+    str.append( " fill=\"none\" d=\"M" );
+    appendPoint( str, path.start );
+    box.add( path.start );
+    for( const Segment& segment : path.segments )
+    {
+        str.append( " C" );
+        for( Vec v : { segment.c1, segment.c2, segment.end } )
+        {
+            str.push_back( ' ' );
+            appendPoint( str, v );
+            box.add( v );
+        }
+    }
+    str.append( "\"/>\n" );
+
+    const Vec normal{ -direction.y * g_arrowWidth, direction.x * g_arrowWidth };
+    str.append( "<polygon" );
+    appendAttribute( str, "fill", strColour );
+    appendAttribute( str, "stroke", strColour );
+    str.append( " points=\"" );
+    appendPoint( str, tip );
+    str.push_back( ' ' );
+    appendPoint( str, base + normal );
+    str.push_back( ' ' );
+    appendPoint( str, base - normal );
+    str.append( "\"/>\n" );
+    box.add( tip );
+    return true;
+}
+
+void Layout::render( std::string& strOutput )
+{
+    const nlohmann::json& nodes     = m_data[ "nodes" ];
+    const nlohmann::json& edges     = m_data[ "edges" ];
+    const nlohmann::json& subgraphs = m_data[ "subgraphs" ];
+
+    std::string str;
+    Box         box;
+    for( std::size_t szNode = 0U; szNode != nodes.size(); ++szNode )
+    {
+        box.add( centre( szNode ), m_widths[ szNode ], m_heights[ szNode ] );
+    }
+
+    // subgraphs
+    for( const auto& subgraph : subgraphs )
+    {
+        Box members;
+        for( const auto& index : subgraph[ "node_indices" ] )
+        {
+            const std::size_t szNode = index.get< std::size_t >();
+            members.add( centre( szNode ), m_widths[ szNode ], m_heights[ szNode ] );
+        }
+        if( members.empty() )
+        {
+            continue;
+        }
+        const Label label = makeLabel( subgraph[ "text" ] );
+        const Vec   topLeft{ members.minX - g_clusterPadding, members.minY - g_clusterPadding - label.height };
+        const Vec   size{ std::max( members.width(), label.width ) + g_clusterPadding * 2.0,
+                        members.height() + label.height + g_clusterPadding * 2.0 };
+        box.add( topLeft );
+        box.add( topLeft + size );
+
+        str.append( "<g class=\"cluster\">" );
+        if( subgraph[ "has_url" ].get< bool >() )
+        {
+            str.append( "<a" );
+            appendAttribute( str, "xlink:href", subgraph[ "url" ].get_ref< const std::string& >() );
+            str.append( ">" );
+        }
+        str.append( "\n<rect" );
+        appendAttribute( str, "x", topLeft.x );
+        appendAttribute( str, "y", topLeft.y );
+        appendAttribute( str, "width", size.x );
+        appendAttribute( str, "height", size.y );
+        str.append( " fill=\"none\" stroke=\"black\" stroke-width=\"2\" stroke-dasharray=\"5,2\"/>\n" );
+        if( !label.empty() )
+        {
+            const std::string& strColour = subgraph[ "colour" ].get_ref< const std::string& >();
+            const Vec          labelTopLeft{ topLeft.x + ( size.x - label.width ) / 2.0, topLeft.y + g_clusterPadding / 2.0 };
+            str.append( "<rect" );
+            appendAttribute( str, "x", labelTopLeft.x );
+            appendAttribute( str, "y", labelTopLeft.y );
+            appendAttribute( str, "width", label.width );
+            appendAttribute( str, "height", label.height );
+            appendAttribute( str, "fill", strColour );
+            str.append( " stroke=\"black\"/>\n" );
+            appendLabel( str, label, labelTopLeft, label.width, "black" );
+        }
+        if( subgraph[ "has_url" ].get< bool >() )
+        {
+            str.append( "</a>" );
+        }
+        str.append( "</g>\n" );
+    }
+
+    // edges and their labels which are drawn last over everything else
+    std::vector< std::pair< Vec, Label > > edgeLabels;
+    const auto                             addEdgeLabel = [ & ]( const nlohmann::json& edge, Vec position )
+    {
+        if( edge[ "has_label" ].get< bool >() )
+        {
+            edgeLabels.emplace_back( position, Label{} );
+            Label& label = edgeLabels.back().second;
+            label.rows.emplace_back();
+            for( const auto& cell : edge[ "label_text" ] )
+            {
+                label.rows.back().push_back( &cell.get_ref< const std::string& >() );
+                label.width += cellWidth( *label.rows.back().back() );
+            }
+            label.height = g_rowHeight;
+        }
+    };
+    for( const Route& route : m_routes )
+    {
+        const nlohmann::json& edge = edges[ route.szEdge ];
+
+        std::vector< Vec > points;
+        for( std::size_t szNode : route.chain )
+        {
+            points.push_back( centre( szNode ) );
+        }
+        if( route.bReversed )
+        {
+            std::reverse( points.begin(), points.end() );
+        }
+        const std::size_t szFrom = edge[ "source" ].get< std::size_t >();
+        const std::size_t szTo   = edge[ "target" ].get< std::size_t >();
+        points.front()           = clip( points.front(), m_widths[ szFrom ], m_heights[ szFrom ], points[ 1 ] );
+        points.back() = clip( points.back(), m_widths[ szTo ], m_heights[ szTo ], points[ points.size() - 2U ] );
+
+        // curves leave and enter each rank along the rank direction
+        Path path{ points.front(), {} };
+        for( std::size_t szPoint = 1U; szPoint != points.size(); ++szPoint )
+        {
+            const Vec from = points[ szPoint - 1U ], to = points[ szPoint ];
+            const Vec middle = ( from + to ) * 0.5;
+            if( m_bHorizontal )
+            {
+                path.segments.push_back( Segment{ Vec{ middle.x, from.y }, Vec{ middle.x, to.y }, to } );
+            }
+            else
+            {
+                path.segments.push_back( Segment{ Vec{ from.x, middle.y }, Vec{ to.x, middle.y }, to } );
+            }
+        }
+        const Vec labelPosition = ( points.size() % 2U == 0U )
+                                      ? ( points[ points.size() / 2U - 1U ] + points[ points.size() / 2U ] ) * 0.5
+                                      : points[ points.size() / 2U ];
+        if( appendEdge( str, box, edge, path ) )
+        {
+            addEdgeLabel( edge, labelPosition );
+        }
+    }
+    for( std::size_t szEdge = 0U; szEdge != edges.size(); ++szEdge )
+    {
+        if( m_routed[ szEdge ] )
+        {
+            continue;
+        }
+        const nlohmann::json& edge   = edges[ szEdge ];
+        const std::size_t     szFrom = edge[ "source" ].get< std::size_t >();
+        const std::size_t     szTo   = edge[ "target" ].get< std::size_t >();
+        const Vec             from   = centre( szFrom );
+        const Vec             to     = centre( szTo );
+        if( szFrom == szTo )
+        {
+            // loop out of one side and back in
+            const double halfWidth = m_widths[ szFrom ] / 2.0, quarterHeight = m_heights[ szFrom ] / 4.0;
+            const Vec    start{ from.x + halfWidth, from.y - quarterHeight };
+            const Vec    end{ from.x + halfWidth, from.y + quarterHeight };
+            Path         path{ start, {} };
+            path.segments.push_back( Segment{ start + Vec{ g_selfLoopSize, -g_selfLoopSize / 2.0 },
+                                              end + Vec{ g_selfLoopSize, g_selfLoopSize / 2.0 }, end } );
+            if( appendEdge( str, box, edge, path ) )
+            {
+                addEdgeLabel( edge, Vec{ from.x + halfWidth + g_selfLoopSize, from.y } );
+            }
+        }
+        else
+        {
+            const Vec start = clip( from, m_widths[ szFrom ], m_heights[ szFrom ], to );
+            Path      path{ start, {} };
+            path.lineTo( clip( to, m_widths[ szTo ], m_heights[ szTo ], from ) );
+            const Vec labelPosition = ( start + path.segments.back().end ) * 0.5;
+            if( appendEdge( str, box, edge, path ) )
+            {
+                addEdgeLabel( edge, labelPosition );
+            }
+        }
+    }
+
+    // nodes
+    for( std::size_t szNode = 0U; szNode != nodes.size(); ++szNode )
+    {
+        const nlohmann::json& node    = nodes[ szNode ];
+        const Vec             topLeft = centre( szNode ) - Vec{ m_widths[ szNode ], m_heights[ szNode ] } * 0.5;
+        const double          border  = node[ "border_width" ].get< double >();
+
+        str.append( "<g class=\"node\">" );
+        if( node[ "has_url" ].get< bool >() )
+        {
+            str.append( "<a" );
+            appendAttribute( str, "xlink:href", node[ "url" ].get_ref< const std::string& >() );
+            str.append( ">" );
+        }
+        str.append( "\n<rect" );
+        appendAttribute( str, "x", topLeft.x + border / 2.0 );
+        appendAttribute( str, "y", topLeft.y + border / 2.0 );
+        appendAttribute( str, "width", m_widths[ szNode ] - border );
+        appendAttribute( str, "height", m_heights[ szNode ] - border );
+        appendAttribute( str, "fill", node[ "bgcolour" ].get_ref< const std::string& >() );
+        if( border > 0.0 )
+        {
+            appendAttribute( str, "stroke", node[ "colour" ].get_ref< const std::string& >() );
+            appendAttribute( str, "stroke-width", border );
+        }
+        str.append( "/>\n" );
+
+        const auto iBookmark = node.find( "bookmark" );
+        appendLabel( str, m_labels[ szNode ], topLeft + Vec{ border, border }, m_widths[ szNode ] - border * 2.0,
+                     node[ "colour" ].get_ref< const std::string& >(),
+                     ( iBookmark != node.end() ) ? &iBookmark->get_ref< const std::string& >() : nullptr,
+                     ( iBookmark != node.end() ) ? &node[ "bookmark_href" ].get_ref< const std::string& >() : nullptr );
+
+        if( node[ "has_url" ].get< bool >() )
+        {
+            str.append( "</a>" );
+        }
+        str.append( "</g>\n" );
+    }
+
+    for( const auto& [ position, label ] : edgeLabels )
+    {
+        const Vec topLeft = position - Vec{ label.width, label.height } * 0.5;
+        box.add( position, label.width, label.height );
+        str.append( "<rect" );
+        appendAttribute( str, "x", topLeft.x );
+        appendAttribute( str, "y", topLeft.y );
+        appendAttribute( str, "width", label.width );
+        appendAttribute( str, "height", label.height );
+        str.append( " fill=\"white\" stroke=\"black\"/>\n" );
+        appendLabel( str, label, topLeft, label.width, "black" );
+    }
+
+    if( box.empty() )
+    {
+        box.add( Vec{ 0.0, 0.0 } );
+    }
+    const double width = box.width() + g_margin * 2.0, height = box.height() + g_margin * 2.0;
+
+    strOutput.reserve( strOutput.size() + str.size() + 512U );
+    strOutput.append( "<svg" );
+    appendAttribute( strOutput, "width", width );
+    appendAttribute( strOutput, "height", height );
+    strOutput.append( " viewBox=\"0 0 " );
+    appendNumber( strOutput, width );
+    strOutput.push_back( ' ' );
+    appendNumber( strOutput, height );
+    strOutput.append( "\" xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+                      "font-family=\"monospace\" font-size=\"10\">\n<g class=\"graph\" transform=\"translate(" );
+    appendPoint( strOutput, Vec{ g_margin - box.minX, g_margin - box.minY } );
+    strOutput.append( ")\">\n" );
+    strOutput.append( str );
+    strOutput.append( "</g>\n</svg>\n" );
+}
+
+} // namespace
+
+void renderSVGGraph( const nlohmann::json& data, std::string& strOutput )
+{
+    Layout layout( data );
+    layout.render( strOutput );
+}
+
+} // namespace report
@@ -0,0 +1,81 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/graphviz.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <graphviz/cgraph.h>
+#include <graphviz/gvc.h>
+
+#include <memory>
+#include <mutex>
+
+namespace report
+{
+namespace
+{
+
+std::mutex g_graphvizMutex;
+
+// NOTE: only ever accessed with g_graphvizMutex held
+GVC_t* getContext()
+{
+    static std::unique_ptr< GVC_t, int ( * )( GVC_t* ) > g_pContext( gvContext(), &gvFreeContext );
+    VERIFY_RTE_MSG( g_pContext, "Failed to create graphviz context" );
+    return g_pContext.get();
+}
+
+inline std::string lastError()
+{
+    const char* pszError = aglasterr();
+    return pszError ? pszError : "unknown error";
+}
+
+} // namespace
+
+std::string renderGraphvizSVG( const std::string& strDot )
+{
+    std::lock_guard< std::mutex > lock( g_graphvizMutex );
+
+    GVC_t* pContext = getContext();
+    agreseterrors();
+
+    std::unique_ptr< Agraph_t, int ( * )( Agraph_t* ) > pGraph( agmemread( strDot.c_str() ), &agclose );
+    VERIFY_RTE_MSG( pGraph, "Graphviz failed to parse graph with error: " << lastError() );
+
+    VERIFY_RTE_MSG( gvLayout( pContext, pGraph.get(), "dot" ) == 0,
+                    "Graphviz failed to layout graph with error: " << lastError() );
+
+    std::string  strSVG;
+    char*        pBuffer  = nullptr;
+    unsigned int uiLength = 0U;
+    const int    iResult  = gvRenderData( pContext, pGraph.get(), "svg", &pBuffer, &uiLength );
+    if( iResult == 0 )
+    {
+        strSVG.assign( pBuffer, uiLength );
+    }
+    gvFreeRenderData( pBuffer );
+    gvFreeLayout( pContext, pGraph.get() );
+
+    VERIFY_RTE_MSG( iResult == 0, "Graphviz failed to render svg with error: " << lastError() );
+    return strSVG;
+}
+
+} // namespace report
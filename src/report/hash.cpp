@@ -0,0 +1,171 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/hash.hpp"
+
+#include <cstring>
+
+namespace report
+{
+namespace
+{
+
+static const std::array< std::uint32_t, 64 > g_roundConstants
+    = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+inline std::uint32_t rotr( std::uint32_t x, unsigned int n )
+{
+    return ( x >> n ) | ( x << ( 32U - n ) );
+}
+
+} // namespace
+
+SHA256::SHA256()
+    : m_state{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 }
+{
+}
+
+void SHA256::compress( const std::uint8_t* pBlock )
+{
+    std::array< std::uint32_t, 64 > w;
+    for( std::size_t i = 0U; i != 16U; ++i )
+    {
+        w[ i ] = ( static_cast< std::uint32_t >( pBlock[ i * 4U ] ) << 24 )
+                 | ( static_cast< std::uint32_t >( pBlock[ i * 4U + 1U ] ) << 16 )
+                 | ( static_cast< std::uint32_t >( pBlock[ i * 4U + 2U ] ) << 8 )
+                 | static_cast< std::uint32_t >( pBlock[ i * 4U + 3U ] );
+    }
+    for( std::size_t i = 16U; i != 64U; ++i )
+    {
+        const std::uint32_t s0 = rotr( w[ i - 15U ], 7 ) ^ rotr( w[ i - 15U ], 18 ) ^ ( w[ i - 15U ] >> 3 );
+        const std::uint32_t s1 = rotr( w[ i - 2U ], 17 ) ^ rotr( w[ i - 2U ], 19 ) ^ ( w[ i - 2U ] >> 10 );
+        w[ i ]                 = w[ i - 16U ] + s0 + w[ i - 7U ] + s1;
+    }
+
+    std::uint32_t a = m_state[ 0 ], b = m_state[ 1 ], c = m_state[ 2 ], d = m_state[ 3 ];
+    std::uint32_t e = m_state[ 4 ], f = m_state[ 5 ], g = m_state[ 6 ], h = m_state[ 7 ];
+    for( std::size_t i = 0U; i != 64U; ++i )
+    {
+        const std::uint32_t s1    = rotr( e, 6 ) ^ rotr( e, 11 ) ^ rotr( e, 25 );
+        const std::uint32_t ch    = ( e & f ) ^ ( ~e & g );
+        const std::uint32_t temp1 = h + s1 + ch + g_roundConstants[ i ] + w[ i ];
+        const std::uint32_t s0    = rotr( a, 2 ) ^ rotr( a, 13 ) ^ rotr( a, 22 );
+        const std::uint32_t maj   = ( a & b ) ^ ( a & c ) ^ ( b & c );
+        const std::uint32_t temp2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    m_state[ 0 ] += a;
+    m_state[ 1 ] += b;
+    m_state[ 2 ] += c;
+    m_state[ 3 ] += d;
+    m_state[ 4 ] += e;
+    m_state[ 5 ] += f;
+    m_state[ 6 ] += g;
+    m_state[ 7 ] += h;
+}
+
+SHA256& SHA256::update( const void* pData, std::size_t szSize )
+{
+    const std::uint8_t* p = static_cast< const std::uint8_t* >( pData );
+    m_uiTotal += szSize;
+
+    // complete any partial block
+    if( m_szBlock != 0U )
+    {
+        const std::size_t szCopy = std::min( szSize, m_block.size() - m_szBlock );
+        std::memcpy( m_block.data() + m_szBlock, p, szCopy );
+        m_szBlock += szCopy;
+        p += szCopy;
+        szSize -= szCopy;
+        if( m_szBlock != m_block.size() )
+        {
+            return *this;
+        }
+        compress( m_block.data() );
+        m_szBlock = 0U;
+    }
+
+    // hash whole blocks in place
+    for( ; szSize >= m_block.size(); p += m_block.size(), szSize -= m_block.size() )
+    {
+        compress( p );
+    }
+
+    std::memcpy( m_block.data(), p, szSize );
+    m_szBlock = szSize;
+    return *this;
+}
+
+SHA256::Digest SHA256::digest()
+{
+    const std::uint64_t uiBits = m_uiTotal * 8U;
+
+    // pad with 0x80 then zeros up to the 8 byte big endian length
+    static const std::uint8_t g_padding[ 64 ] = { 0x80 };
+    update( g_padding, ( m_szBlock < 56U ) ? ( 56U - m_szBlock ) : ( 120U - m_szBlock ) );
+
+    std::uint8_t length[ 8 ];
+    for( std::size_t i = 0U; i != 8U; ++i )
+    {
+        length[ i ] = static_cast< std::uint8_t >( uiBits >> ( 56U - i * 8U ) );
+    }
+    update( length, sizeof( length ) );
+
+    Digest result;
+    for( std::size_t i = 0U; i != m_state.size(); ++i )
+    {
+        result[ i * 4U ]      = static_cast< std::uint8_t >( m_state[ i ] >> 24 );
+        result[ i * 4U + 1U ] = static_cast< std::uint8_t >( m_state[ i ] >> 16 );
+        result[ i * 4U + 2U ] = static_cast< std::uint8_t >( m_state[ i ] >> 8 );
+        result[ i * 4U + 3U ] = static_cast< std::uint8_t >( m_state[ i ] );
+    }
+    return result;
+}
+
+std::string SHA256::toHex( const Digest& digest )
+{
+    static const char g_hexDigits[] = "0123456789abcdef";
+
+    std::string strResult;
+    strResult.reserve( digest.size() * 2U );
+    for( std::uint8_t byte : digest )
+    {
+        strResult.push_back( g_hexDigits[ byte >> 4 ] );
+        strResult.push_back( g_hexDigits[ byte & 0x0F ] );
+    }
+    return strResult;
+}
+
+} // namespace report
@@ -0,0 +1,146 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/html_assets.hpp"
+#include "report/hash.hpp"
+#include "report/html_escape.hpp"
+
+#include "common/assert_verify.hpp"
+#include "common/file.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+namespace report
+{
+namespace
+{
+// the width or height of the root svg element as a css length or empty if there is none
+std::string svgLength( std::string_view strSVG, std::string_view strAttribute )
+{
+    const std::size_t szStart = strSVG.find( "<svg" );
+    if( szStart == std::string_view::npos )
+    {
+        return {};
+    }
+    const std::string_view strTag  = strSVG.substr( szStart, strSVG.find( '>', szStart ) - szStart );
+    const std::string      strFind = std::string( strAttribute ) + "=\"";
+
+    const auto isSpace = []( char c ) { return std::isspace( static_cast< unsigned char >( c ) ) != 0; };
+    const auto isAlpha = []( char c ) { return std::isalpha( static_cast< unsigned char >( c ) ) != 0; };
+
+    std::size_t szPos = strTag.find( strFind );
+    while( ( szPos != std::string_view::npos ) && !isSpace( strTag[ szPos - 1U ] ) )
+    {
+        szPos = strTag.find( strFind, szPos + 1U );
+    }
+    if( szPos == std::string_view::npos )
+    {
+        return {};
+    }
+    szPos += strFind.size();
+    const std::string_view strValue = strTag.substr( szPos, strTag.find( '"', szPos ) - szPos );
+
+    // a number optionally followed by units such as the pt graphviz uses
+    const std::size_t szUnits = strValue.find_first_not_of( "0123456789." );
+    const bool        bUnits  = szUnits != std::string_view::npos;
+    if( strValue.empty() || ( szUnits == 0U )
+        || ( bUnits && !std::all_of( strValue.begin() + szUnits, strValue.end(), isAlpha ) ) )
+    {
+        return {};
+    }
+    return std::string( strValue ) + ( bUnits ? "" : "px" );
+}
+
+} // namespace
+
+HTMLAssets::HTMLAssets( const boost::filesystem::path& directory, const std::string& strURL )
+    : m_directory( directory )
+    , m_strURL( strURL )
+{
+    boost::filesystem::create_directories( m_directory );
+    VERIFY_RTE_MSG(
+        boost::filesystem::exists( m_directory ), "Failed to create report asset folder: " << m_directory.string() );
+    if( !m_strURL.empty() && ( m_strURL.back() != '/' ) )
+    {
+        m_strURL.push_back( '/' );
+    }
+}
+
+std::string HTMLAssets::store( std::string_view strContent, std::string_view strExtension ) const
+{
+    const std::string             strFileName = sha256( strContent ) + std::string( strExtension );
+    const boost::filesystem::path filePath    = m_directory / strFileName;
+    if( !boost::filesystem::exists( filePath ) )
+    {
+        // write to a unique temporary file and rename so readers never see a partial asset
+        const boost::filesystem::path tempPath
+            = m_directory / boost::filesystem::unique_path( "%%%%-%%%%-%%%%.tmp" );
+        {
+            auto pFile = boost::filesystem::createNewFileStream( tempPath );
+            pFile->write( strContent.data(), strContent.size() );
+        }
+        boost::filesystem::rename( tempPath, filePath );
+    }
+    return m_strURL + strFileName;
+}
+
+std::string HTMLAssets::svgPlaceholder( std::string_view strSVG, const nlohmann::json& bookmarks ) const
+{
+    std::string str( "<div class=\"report_svg\" data-src=\"" );
+    escapeHTML( store( strSVG, ".svg" ), str );
+    str.push_back( '"' );
+
+    const std::string strWidth = svgLength( strSVG, "width" ), strHeight = svgLength( strSVG, "height" );
+    if( !strWidth.empty() && !strHeight.empty() )
+    {
+        str.append( " style=\"width:" ).append( strWidth ).append( ";height:" ).append( strHeight ).append( "\"" );
+    }
+
+    if( !bookmarks.empty() )
+    {
+        str.append( " data-bookmarks=\"" );
+        escapeHTML( bookmarks.dump( -1, ' ', false, nlohmann::json::error_handler_t::replace ), str );
+        str.push_back( '"' );
+    }
+    str.append( "></div>" );
+    return str;
+}
+
+bool HTMLAssets::hasPlaceholderFiles( std::string_view strHTML ) const
+{
+    static const std::string_view strSource = "<div class=\"report_svg\" data-src=\"";
+    const std::string             strURL    = escapeHTML( m_strURL );
+    for( std::size_t szPos = strHTML.find( strSource ); szPos != std::string_view::npos;
+         szPos             = strHTML.find( strSource, szPos ) )
+    {
+        szPos += strSource.size();
+        const std::string_view strSrc = strHTML.substr( szPos, strHTML.find( '"', szPos ) - szPos );
+        if( ( strSrc.substr( 0U, strURL.size() ) != strURL )
+            || !boost::filesystem::exists( m_directory / std::string( strSrc.substr( strURL.size() ) ) ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace report
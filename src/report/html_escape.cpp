@@ -0,0 +1,154 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/html_escape.hpp"
+
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define REPORT_ESCAPE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined( _MSC_VER ) && !defined( __clang__ )
+#include <intrin.h>
+#endif
+
+namespace report
+{
+namespace
+{
+
+// NOTE: the record separator is escaped as the inja renderer marks template slots with it
+static const char g_recordSeparator = '\x1e';
+
+inline bool isSpecial( char c )
+{
+    return c == '&' || c == '\"' || c == '\'' || c == '<' || c == '>' || c == g_recordSeparator;
+}
+
+inline int firstBit( unsigned int uiMask )
+{
+#if defined( _MSC_VER ) && !defined( __clang__ )
+    unsigned long ulIndex;
+    _BitScanForward( &ulIndex, uiMask );
+    return static_cast< int >( ulIndex );
+#else
+    return __builtin_ctz( uiMask );
+#endif
+}
+
+// returns the first special character in [ p, pEnd ) or pEnd
+inline const char* findSpecial( const char* p, const char* pEnd )
+{
+#if defined( __AVX2__ )
+    const __m256i amp  = _mm256_set1_epi8( '&' );
+    const __m256i quot = _mm256_set1_epi8( '\"' );
+    const __m256i apos = _mm256_set1_epi8( '\'' );
+    const __m256i lt   = _mm256_set1_epi8( '<' );
+    const __m256i gt   = _mm256_set1_epi8( '>' );
+    const __m256i rs   = _mm256_set1_epi8( g_recordSeparator );
+    for( ; pEnd - p >= 32; p += 32 )
+    {
+        const __m256i chars = _mm256_loadu_si256( reinterpret_cast< const __m256i* >( p ) );
+        const __m256i match = _mm256_or_si256(
+            _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( chars, amp ), _mm256_cmpeq_epi8( chars, quot ) ),
+                             _mm256_or_si256( _mm256_cmpeq_epi8( chars, apos ), _mm256_cmpeq_epi8( chars, lt ) ) ),
+            _mm256_or_si256( _mm256_cmpeq_epi8( chars, gt ), _mm256_cmpeq_epi8( chars, rs ) ) );
+        const unsigned int uiMask = static_cast< unsigned int >( _mm256_movemask_epi8( match ) );
+        if( uiMask != 0U )
+        {
+            return p + firstBit( uiMask );
+        }
+    }
+#elif defined( REPORT_ESCAPE_SSE2 )
+    const __m128i amp  = _mm_set1_epi8( '&' );
+    const __m128i quot = _mm_set1_epi8( '\"' );
+    const __m128i apos = _mm_set1_epi8( '\'' );
+    const __m128i lt   = _mm_set1_epi8( '<' );
+    const __m128i gt   = _mm_set1_epi8( '>' );
+    const __m128i rs   = _mm_set1_epi8( g_recordSeparator );
+    for( ; pEnd - p >= 16; p += 16 )
+    {
+        const __m128i chars = _mm_loadu_si128( reinterpret_cast< const __m128i* >( p ) );
+        const __m128i match
+            = _mm_or_si128( _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( chars, amp ), _mm_cmpeq_epi8( chars, quot ) ),
+                                          _mm_or_si128( _mm_cmpeq_epi8( chars, apos ), _mm_cmpeq_epi8( chars, lt ) ) ),
+                            _mm_or_si128( _mm_cmpeq_epi8( chars, gt ), _mm_cmpeq_epi8( chars, rs ) ) );
+        const unsigned int uiMask = static_cast< unsigned int >( _mm_movemask_epi8( match ) );
+        if( uiMask != 0U )
+        {
+            return p + firstBit( uiMask );
+        }
+    }
+#endif
+    // scalar tail or fallback
+    for( ; p != pEnd; ++p )
+    {
+        if( isSpecial( *p ) )
+        {
+            return p;
+        }
+    }
+    return pEnd;
+}
+
+} // namespace
+
+void escapeHTML( std::string_view str, std::string& strOutput )
+{
+    // assume mostly plain text
+    strOutput.reserve( strOutput.size() + str.size() );
+
+    const char* p    = str.data();
+    const char* pEnd = p + str.size();
+    while( p != pEnd )
+    {
+        const char* pSpecial = findSpecial( p, pEnd );
+        strOutput.append( p, pSpecial );
+        if( pSpecial == pEnd )
+        {
+            break;
+        }
+        switch( *pSpecial )
+        {
+            case '&':
+                strOutput.append( "&amp;", 5 );
+                break;
+            case '\"':
+                strOutput.append( "&quot;", 6 );
+                break;
+            case '\'':
+                strOutput.append( "&apos;", 6 );
+                break;
+            case '<':
+                strOutput.append( "&lt;", 4 );
+                break;
+            case '>':
+                strOutput.append( "&gt;", 4 );
+                break;
+            case g_recordSeparator:
+                strOutput.append( "&#30;", 5 );
+                break;
+        }
+        p = pSpecial + 1;
+    }
+}
+
+} // namespace report
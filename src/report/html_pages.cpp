@@ -0,0 +1,159 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/html_pages.hpp"
+#include "report/html_escape.hpp"
+
+#include "common/assert_verify.hpp"
+#include "common/file.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace report
+{
+
+std::streamsize PageBuffer::xsputn( const char* pData, std::streamsize szSize )
+{
+    if( m_str.size() + static_cast< std::size_t >( szSize ) > m_szLimit )
+    {
+        m_bOverflowed = true;
+        THROW_RTE( "Page size limit of " << m_szLimit << " bytes exceeded" );
+    }
+    m_str.append( pData, static_cast< std::size_t >( szSize ) );
+    return szSize;
+}
+
+PageBuffer::int_type PageBuffer::overflow( int_type ch )
+{
+    if( !traits_type::eq_int_type( ch, traits_type::eof() ) )
+    {
+        const char c = traits_type::to_char_type( ch );
+        xsputn( &c, 1 );
+    }
+    return traits_type::not_eof( ch );
+}
+
+HTMLPageWriter::HTMLPageWriter( const HTMLTemplateEngine& engine, const boost::filesystem::path& directory )
+    : m_engine( engine )
+    , m_directory( directory )
+{
+    boost::filesystem::create_directories( m_directory );
+    VERIFY_RTE_MSG(
+        boost::filesystem::exists( m_directory ), "Failed to create report folder: " << m_directory.string() );
+}
+
+std::string HTMLPageWriter::pageName( std::size_t szPage )
+{
+    return "page_" + std::to_string( szPage + 1U ) + ".html";
+}
+
+nlohmann::json HTMLPageWriter::pageData( std::string strBody ) const
+{
+    nlohmann::json data( { { "body", std::move( strBody ) },
+                           { "reports", nlohmann::json::array() },
+                           { "has_navigation", false },
+                           { "has_bookmark_map", true },
+                           { "bookmark_map", BOOKMARK_MAP } } );
+    m_engine.addPageAssets( data );
+    return data;
+}
+
+void HTMLPageWriter::writePage( const std::string& strName, const nlohmann::json& data )
+{
+    const boost::filesystem::path filePath = m_directory / strName;
+    {
+        auto pFile = boost::filesystem::createNewFileStream( filePath );
+        m_engine.render( HTMLTemplateEngine::eReport, data, *pFile );
+    }
+    m_files.push_back( filePath );
+}
+
+void HTMLPageWriter::writePendingPage( bool bHasNext )
+{
+    const std::size_t szPage = m_titles.size() - 1U;
+    nlohmann::json    data   = pageData( std::move( m_pendingBodyOpt.value() ) );
+    m_pendingBodyOpt.reset();
+
+    data[ "has_navigation" ] = true;
+    data[ "index" ]          = INDEX_PAGE;
+    data[ "has_previous" ]   = szPage != 0U;
+    data[ "previous" ]       = szPage != 0U ? pageName( szPage - 1U ) : std::string{};
+    data[ "has_next" ]       = bHasNext;
+    data[ "next" ]           = pageName( szPage + 1U );
+    writePage( pageName( szPage ), data );
+}
+
+void HTMLPageWriter::addPage( const std::string& strTitle, std::string strBody )
+{
+    if( m_pendingBodyOpt.has_value() )
+    {
+        writePendingPage( true );
+    }
+    m_titles.push_back( strTitle );
+    m_pendingBodyOpt = std::move( strBody );
+}
+
+std::vector< boost::filesystem::path > HTMLPageWriter::finish( const std::string& strTitle )
+{
+    if( m_pendingBodyOpt.has_value() )
+    {
+        writePendingPage( false );
+    }
+
+    // the index lists every page under the report title
+    {
+        nlohmann::json index( { { "style", "branch_default" },
+                                { "has_bookmark", false },
+                                { "bookmark", "" },
+                                { "collapsed", false },
+                                { "label", nlohmann::json::array( { escapeHTML( strTitle ) } ) },
+                                { "elements", nlohmann::json::array() } } );
+        for( std::size_t szPage = 0U; szPage != m_titles.size(); ++szPage )
+        {
+            index[ "elements" ].push_back( "<a href=\"" + pageName( szPage ) + "\">" + escapeHTML( m_titles[ szPage ] )
+                                           + "</a>" );
+        }
+        std::ostringstream osBody;
+        m_engine.render( HTMLTemplateEngine::eBranch, index, osBody );
+        writePage( INDEX_PAGE, pageData( osBody.str() ) );
+        std::rotate( m_files.begin(), m_files.end() - 1, m_files.end() );
+    }
+
+    {
+        nlohmann::json bookmarks = nlohmann::json::object();
+        for( const auto& [ strBookmark, szPage ] : m_bookmarks )
+        {
+            bookmarks[ strBookmark ] = pageName( szPage );
+        }
+        const boost::filesystem::path filePath = m_directory / BOOKMARK_MAP;
+        {
+            auto pFile = boost::filesystem::createNewFileStream( filePath );
+            *pFile << "reportBookmarks = "
+                   << bookmarks.dump( -1, ' ', false, nlohmann::json::error_handler_t::replace ) << ";\n";
+        }
+        m_files.push_back( filePath );
+    }
+
+    return m_files;
+}
+
+} // namespace report
@@ -19,421 +19,270 @@
 //  OF THE POSSIBILITY OF SUCH DAMAGES.
 
 #include "report/html_template_engine.hpp"
+#include "report/compiled_templates.hpp"
+#include "report/deferred_output.hpp"
+#include "report/external_process.hpp"
+#include "report/graph_layout.hpp"
+#include "report/graphviz.hpp"
+#include "report/hash.hpp"
+#include "report/html_assets.hpp"
+#include "report/svg_bookmarks.hpp"
+#include "report/svg_plot.hpp"
 
-#include "common/string.hpp"
 #include "common/assert_verify.hpp"
 #include "common/file.hpp"
-#include "common/process.hpp"
 
 #include "inja/inja.hpp"
 #include "inja/environment.hpp"
 #include "inja/template.hpp"
 
-#include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <future>
+#include <sstream>
+#include <string_view>
+
 namespace report
 {
 namespace
 {
 
-// clang-format off
-static std::array< std::string, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES > g_defaultTemplates = {
-
-/////////////////////////////////////////////////////////////////
-// report template
-R"TEMPLATE(
+using CompiledTemplate = void ( * )( const nlohmann::json&, std::ostream&, TemplateSlots* );
 
-<html>
-
-<head>
-<style>
-table
-{
-    font-size:14px;
-    font-family:monospace;
-    border-collapse: collapse;
-}
-th
-{
-    border: 2px solid darkblue;
-    border-collapse: collapse;
-}
-td 
+// NOTE: the default templates are generated at build time from src/report/templates/*.jinja
+// both as source for the inja fallback and as compiled render functions
+const std::array< std::string_view, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES >& defaultTemplates()
 {
-    border: 1px solid darkblue;
-    border-collapse: collapse;
+    static const std::array< std::string_view, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES > g_defaultTemplates
+        = { templates::report_source, templates::multiline_source, templates::branch_source,
+            templates::table_source,  templates::plot_source,      templates::graph_source,
+            templates::style_source,  templates::script_source };
+    return g_defaultTemplates;
 }
-.multiline_default
-{
-    white-space:pre;
-    font-size:14px;
-    font-family:monospace;
-    background-color:#b0c0c0;
-}
-.branch_default
+
+// registry of the default templates parsed for inja which are parsed on first use only
+const inja::Template& defaultTemplate( HTMLTemplateEngine::TemplateType templateType )
 {
-    font-size:14px;
-    font-family:monospace;
-    background-color:#cfdfdf;
+    using TemplatePtr = std::unique_ptr< const inja::Template >;
+    static std::array< std::once_flag, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES > g_parsed;
+    static std::array< TemplatePtr, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES >    g_templates;
+
+    std::call_once( g_parsed[ templateType ],
+                    [ templateType ]()
+                    {
+                        // NOTE: parsed templates do not refer to the environment that parsed them
+                        inja::Environment environment;
+                        environment.set_trim_blocks( true );
+                        g_templates[ templateType ] = std::make_unique< const inja::Template >(
+                            environment.parse( std::string( defaultTemplates()[ templateType ] ) ) );
+                    } );
+    return *g_templates[ templateType ];
 }
-</style>
-</head>
 
-<body>
+const std::array< CompiledTemplate, HTMLTemplateEngine::TOTAL_TEMPLATE_TYPES > g_compiledTemplates
+    = { &templates::render_report, &templates::render_multiline, &templates::render_branch,
+        &templates::render_table,  &templates::render_plot,      &templates::render_graph,
+        &templates::render_style,  &templates::render_script };
 
-<script type="text/javascript">
+// inja cannot call back into TemplateSlots so placeholders are replaced with sentinel
+// strings and the rendered output is split on them.  Any sentinel in the data itself is
+// replaced by its character reference first.
+static const char g_slotSentinel = '\x1e';
 
-    currentReportType = "home"
-    
-    stateMachine = function() 
+nlohmann::json sentinelSlots( const nlohmann::json& data )
+{
+    if( auto slotOpt = TemplateSlots::slot( data ); slotOpt.has_value() )
     {
-        const queryString = window.location.search
-        const urlParams = new URLSearchParams(queryString);
-
-        if( window.location.hash.length === 0 )
+        return g_slotSentinel + std::to_string( slotOpt.value() ) + g_slotSentinel;
+    }
+    else if( data.is_structured() )
+    {
+        nlohmann::json result = data.is_array() ? nlohmann::json::array() : nlohmann::json::object();
+        for( auto i = data.begin(), iEnd = data.end(); i != iEnd; ++i )
         {
-            // no fragment - nothing to do
-            console.log( "No fragment nothing to do" )
+            if( data.is_array() )
+                result.push_back( sentinelSlots( i.value() ) );
+            else
+                result[ i.key() ] = sentinelSlots( i.value() );
         }
-        else
+        return result;
+    }
+    else if( data.is_string() )
+    {
+        // escapeHTML already replaces the sentinel but text such as urls is not escaped
+        const std::string& str = data.get_ref< const std::string& >();
+        if( str.find( g_slotSentinel ) != std::string::npos )
         {
-            hash = window.location.hash.substring( 1 )
-            const element = document.getElementById( hash );
-            if( element )
+            std::string strResult;
+            for( char c : str )
             {
-                element.scrollIntoView({ behavior: "smooth", block: "center", inline: "center" });
-                console.log( "Scrolled to element: " + hash )
-            }
-            else
-            {I
-                console.log( "Could not locate element: " + hash )
+                if( c == g_slotSentinel )
+                    strResult.append( "&#30;" );
+                else
+                    strResult.push_back( c );
             }
-        }
-
-        if( urlParams.has( "report" ) )
-        {
-            currentReportType = urlParams.get( "report" )
-            console.log( "Report Type is: " + currentReportType )
+            return strResult;
         }
     }
+    return data;
+}
 
-    window.onrefresh    = stateMachine
-    window.onload       = stateMachine
-    
-    function keyCodeToReportType( keyCode )
+void writeSlots( const std::string& str, std::ostream& os, TemplateSlots& slots )
+{
+    std::size_t szPos = 0U;
+    for( std::size_t szStart = str.find( g_slotSentinel ); szStart != std::string::npos;
+         szStart             = str.find( g_slotSentinel, szPos ) )
     {
-        if( keyCode == 0 )
-        {
-            return ""
-        }
-{% for report in reports %}
-        else if( keyCode == {{ report.key_code }} )
-        {
-            return "{{ report.name }}";
-        }
-{% endfor %}
-        return ""
+        const std::size_t szEnd = str.find( g_slotSentinel, szStart + 1 );
+        VERIFY_RTE_MSG( szEnd != std::string::npos, "Unterminated template slot" );
+        os.write( str.data() + szPos, szStart - szPos );
+        slots.write( std::stoul( str.substr( szStart + 1, szEnd - szStart - 1 ) ), os );
+        szPos = szEnd + 1;
     }
+    os.write( str.data() + szPos, str.size() - szPos );
+}
 
-    document.onkeypress = function (e) 
-    {
-        e = e || window.event;
-        lastKeyPressed = e.keyCode
-        console.log( "onkeypress= " + lastKeyPressed )
-        currentReportType = keyCodeToReportType( lastKeyPressed );
-        console.log( "Report Type is: " + currentReportType )
-    };
+// the plot data is passed inline to gnuplot as a named data block ahead of the script
+static const char* g_gnuplotDataBlock = "$data";
 
-    function navigateTo( path, params, fragment ) 
+// plot templates written before the svg was read from stdout set the output to a file which
+// would leave nothing to read so any quoted output name is rejected
+inline bool setsOutputFile( const std::string& strScript )
+{
+    static const std::string_view strSetOutput = "set output";
+    for( std::size_t szPos = strScript.find( strSetOutput ); szPos != std::string::npos;
+         szPos             = strScript.find( strSetOutput, szPos + 1U ) )
     {
-        if( params )
-        {
-            newLocation = path + "?" + params + "&report=" + currentReportType
-        }
-        else
-        {
-            newLocation = path + "?report=" + currentReportType
-        }
-
-        if( fragment )
+        const std::size_t szName = strScript.find_first_not_of( " \t", szPos + strSetOutput.size() );
+        if( ( szName != std::string::npos ) && ( strScript[ szName ] == '\"' || strScript[ szName ] == '\'' ) )
         {
-            newLocation = newLocation + "#" + fragment
+            return true;
         }
-
-        console.log( "href= " + newLocation + "\n" )
-
-        window.location.href = newLocation
     }
+    return false;
+}
 
-</script>
-
-<div style="position:relative;min-width:960px">
-    <table style="position: absolute;right:0;top:0">
-        <tr><th>Report</th><th>Shortcut Key</th></tr>
-        {% for report in reports %}
-        <tr><td>{{ report.name }}</td><td>{{ report.key_char }}</td></tr>
-        {% endfor %}
-    </table>
-</div>
-
-{{ body }}
-</body>
+inline std::string filterSVG( const std::function< std::string( std::string ) >& filter, std::string strSVG )
+{
+    return filter ? filter( std::move( strSVG ) ) : strSVG;
+}
 
-</html>
+inline std::string gnuplotInput( const std::string& strData, const std::string& strScript )
+{
+    std::string strInput;
+    strInput.reserve( strData.size() + strScript.size() + 32U );
+    strInput.append( g_gnuplotDataBlock );
+    strInput.append( " << EOD\n" );
+    strInput.append( strData );
+    strInput.append( "EOD\n" );
+    strInput.append( strScript );
+    return strInput;
+}
 
-)TEMPLATE",
+// NOTE: bump the version whenever the svg post processing changes to invalidate cached svgs
+static const std::string_view g_svgCacheVersion = "report.svg.2";
 
-/////////////////////////////////////////////////////////////////
-// multiline template
-R"TEMPLATE(<div class="{{style}}" style="color:{{ colour }};background-color:{{ background_colour }};" {% if has_bookmark %}id="{{ bookmark }}"{% endif %}>{% if has_link %}<a href="{{ link }}">{% endif %}{% for element in elements %}{{ element }}{% endfor %}{% if has_link %}</a>{% endif %}</div>)TEMPLATE",
-
-/////////////////////////////////////////////////////////////////
-// branch template
-R"TEMPLATE(
-<div class="{{style}}" {% if has_bookmark %}id="{{ bookmark }}"{% endif %}>{% for element in label %}{{ element }}{% endfor %}</div>
-<ul class="{{style}}" >
-{% for element in elements %}
-    <li>{{ element }}</li>
-{% endfor %}
-</ul>
-
-)TEMPLATE",
-
-/////////////////////////////////////////////////////////////////
-// table template
-R"TEMPLATE(
-<table>
-{% if headings %}
-<tr>
-{% for heading in headings %}
-<th>{{ heading }}</th>
-{% endfor %}
-</tr>
-{% endif %}
-{% for row in rows %}
-<tr>
-{% for value in row.values %}
-<td>{{ value }}</td>
-{% endfor %}
-</tr>
-{% endfor %}
-</table>)TEMPLATE",
-
-/////////////////////////////////////////////////////////////////
-// plot template
-R"TEMPLATE(
-
-set terminal svg size 600,400 dynamic enhanced font 'arial,10' mousing name "plot" dashlength 1.0 
-
-set output "plot.svg"
-
-set key fixed left top vertical Right noreverse enhanced autotitle box lt black linewidth 1.000 dashtype solid
-
-set xlabel "Execution Date" 
-set ylabel "Benchmark Time ( ns )" 
-
-set title "{% for heading in headings %}{{ heading }} {% endfor %}" 
-set title font ",20" textcolor lt -1 norotate
-
-set boxwidth 0.75 relative
-
-set style fill transparent solid 0.5
-
-set bars linecolor 'blue' linewidth 1.0 dashtype '.'
-
-plot 'plot.dat' with boxes fc 'blue', \
-    '' with labels hypertext
-
-
-
-)TEMPLATE",
-
-/////////////////////////////////////////////////////////////////
-// graph template
-R"TEMPLATE(digraph
-{
-    rankdir       = {{ rank_direction }};
-    ratio         = auto;
-    concentrate   = True;
-
-    node 
-    [ 
-        shape       = rectangle 
-        style       = solid
-        penwidth    = 1
-        fontname    = monospace
-        fontsize    = 10
-        fontcolor   = black
-        margin      = 0 
-        width       = 0 
-        height      = 0
-    ];
-
-    edge 
-    [ 
-        fontname  = monospace
-        fontsize  = 10
-        fontcolor = black
-    ];
-
-    graph 
-    [
-        splines   = true 
-        overlap   = false
-    ]
-
-{% for node in nodes %}
-    "{{ node.name }}" 
-    [
-{% if node.has_url %}
-        URL         = "{{ node.url }}"
-{% endif %}
-        label       = 
-        <
-            <table 
-                border      = "{{ node.border_width }}" 
-                color       = "{{ node.colour }}" 
-                cellborder  = "1"
-                cellpadding = "1"
-                cellspacing = "0"
-                bgcolor     = "{{ node.bgcolour }}"
-            >
-            {% for row in node.rows %}
-            <tr>
-            {% for value in row.values %}
-                {{ value }}
-            {% endfor %}
-            </tr>
-            {% endfor %}
-            </table>
-        >
-    ];
-{% endfor %}
-
-{% for subgraph in subgraphs %}
-    subgraph {{ subgraph.name }}
-    {
-        style       = dashed
-        penwidth    = 2
-{% if subgraph.has_url %}
-        URL         = "{{ subgraph.url }}"
-{% endif %}
-{% if subgraph.has_label %}
-        label       = 
-        <
-            <table 
-                border      = "1" 
-                cellborder  = "1" 
-                cellpadding = "0"
-                bgcolor     = "{{ subgraph.colour }}"
-            >
-            {% for row in subgraph.rows %}
-            <tr>
-            {% for value in row.values %}
-                {{ value }}
-            {% endfor %}
-            </tr>
-            {% endfor %}
-            </table>
-        >
-{% endif %}
-
-{% for node in subgraph.nodes %}
-        {{ node }};
-{% endfor %}
-    }
-{% endfor %}
-
-{% for edge in edges %}
-    {{ edge.from }} -> {{ edge.to }}
-    [
-{% if edge.has_label %}
-        label       = 
-        <
-            <table 
-                border      = "1" 
-                cellborder  = "1" 
-                cellpadding = "0"
-            >
-            <tr>
-            {% for value in edge.label %}
-                {{ value }}
-            {% endfor %}
-            </tr>
-            </table>
-        >
-{% endif %}
-        penwidth    = "{{ edge.line_width }}"
-        color       = "{{ edge.colour }}"
-        style       = "{{ edge.style }}"
-        constraint  = {{ edge.constraint }}
-    ]
-
-{% endfor %}
-})TEMPLATE"
-
-};
-// clang-format on
+std::string contentCacheKey( std::string_view strGenerator, std::initializer_list< std::string_view > inputs )
+{
+    SHA256 hash;
+    hash.update( g_svgCacheVersion ).update( "\n" ).update( strGenerator );
+    for( std::string_view strInput : inputs )
+    {
+        // length prefix each input so that boundaries cannot be shifted between them
+        const std::string strLength = "\n" + std::to_string( strInput.size() ) + "\n";
+        hash.update( strLength ).update( strInput );
+    }
+    return hash.hexDigest();
+}
 
 } // namespace
 
-HTMLTemplateEngine::HTMLTemplateEngine( bool bClearTempFiles )
+HTMLTemplateEngine::HTMLTemplateEngine( bool, bool bCompiledTemplates )
     : m_pEnvironment( std::make_unique< inja::Environment >() )
-    , m_templateNames{ "report.jinja", "multiline.jinja", "branch.jinja", "table.jinja", "plot.jinja", "graph.jinja" }
-    , m_tempFolder( boost::filesystem::temp_directory_path() / "graphs" / common::uuid() )
-    , m_bClearTempFiles( bClearTempFiles )
+    , m_templateNames{ "report.jinja", "multiline.jinja", "branch.jinja", "table.jinja",
+                       "plot.jinja",   "graph.jinja",     "style.jinja",  "script.jinja" }
 {
-    boost::filesystem::create_directories( m_tempFolder );
-    VERIFY_RTE_MSG(
-        boost::filesystem::exists( m_tempFolder ), "Failed to create temporary folder: " << m_tempFolder.string() );
-
     m_pEnvironment->set_trim_blocks( true );
-    for( unsigned int i = 0U; i != TOTAL_TEMPLATE_TYPES; ++i )
+
+    // otherwise the shared default templates are used in place of m_templates
+    if( bCompiledTemplates )
     {
-        const auto templateType = static_cast< TemplateType >( i );
-        // use default templates instead of loading from disk
-        m_templates[ templateType ]
-            = std::make_unique< inja::Template >( m_pEnvironment->parse( g_defaultTemplates[ i ] ) );
+        m_compiledTemplates = g_compiledTemplates;
     }
 }
 
-HTMLTemplateEngine::HTMLTemplateEngine( const boost::filesystem::path& templateDir, bool bClearTempFiles )
+HTMLTemplateEngine::HTMLTemplateEngine( const boost::filesystem::path& templateDir, bool )
     : m_pEnvironment( std::make_unique< inja::Environment >() )
-    , m_templateNames{ "report.jinja", "multiline.jinja", "branch.jinja", "table.jinja", "plot.jinja", "graph.jinja" }
-    , m_tempFolder( boost::filesystem::temp_directory_path() / "graphs" / common::uuid() )
-    , m_bClearTempFiles( bClearTempFiles )
+    , m_templateNames{ "report.jinja", "multiline.jinja", "branch.jinja", "table.jinja",
+                       "plot.jinja",   "graph.jinja",     "style.jinja",  "script.jinja" }
 {
-    boost::filesystem::create_directories( m_tempFolder );
-    VERIFY_RTE_MSG(
-        boost::filesystem::exists( m_tempFolder ), "Failed to create temporary folder: " << m_tempFolder.string() );
-
     m_pEnvironment->set_trim_blocks( true );
+
+    // custom templates are part of the key of cached fragments
+    SHA256 templateHash;
     for( unsigned int i = 0U; i != TOTAL_TEMPLATE_TYPES; ++i )
     {
         const auto templateType = static_cast< TemplateType >( i );
         auto       templatePath = templateDir / m_templateNames[ templateType ];
+
+        // the page style and script were once part of the report template so may be left out
+        const bool bOptional    = ( templateType == eStyle ) || ( templateType == eScript );
+        if( bOptional && !boost::filesystem::exists( templatePath ) )
+        {
+            continue;
+        }
         VERIFY_RTE_MSG(
             boost::filesystem::exists( templatePath ), "Failed to locate report template: " << templatePath.string() );
 
         m_templates[ templateType ]
             = std::make_unique< inja::Template >( m_pEnvironment->parse_template( templatePath.string() ) );
+
+        std::string strTemplate;
+        boost::filesystem::loadAsciiFile( templatePath, strTemplate );
+        templateHash.update( sha256( strTemplate ) );
     }
+    m_strTemplateHash = templateHash.hexDigest();
 }
 
 HTMLTemplateEngine::~HTMLTemplateEngine()
 {
-    if( m_bClearTempFiles )
-    {
-        boost::filesystem::remove_all( m_tempFolder );
-    }
+    // outstanding jobs use the engine
+    m_pProcessTasks.reset();
 }
 
-void HTMLTemplateEngine::renderTemplate( const nlohmann::json& data, TemplateType templateType, std::ostream& os )
+const HTMLTemplateEngine& HTMLTemplateEngine::getDefault()
 {
+    static const HTMLTemplateEngine g_defaultEngine{ false };
+    return g_defaultEngine;
+}
+
+void HTMLTemplateEngine::renderTemplate( const nlohmann::json& data, TemplateType templateType, std::ostream& os,
+                                         TemplateSlots* pSlots ) const
+{
+    // NOTE: inja renders with a new Renderer per call so the environment and parsed
+    // templates are only read and can be shared by concurrent renders
     try
     {
-        m_pEnvironment->render_to( os, *m_templates[ templateType ], data );
+        if( m_compiledTemplates[ templateType ] )
+        {
+            m_compiledTemplates[ templateType ]( data, os, pSlots );
+        }
+        else
+        {
+            const inja::Template& tmpl
+                = m_templates[ templateType ] ? *m_templates[ templateType ] : defaultTemplate( templateType );
+            if( pSlots )
+            {
+                std::ostringstream osTemplate;
+                m_pEnvironment->render_to( osTemplate, tmpl, sentinelSlots( data ) );
+                writeSlots( osTemplate.str(), os, *pSlots );
+            }
+            else
+            {
+                m_pEnvironment->render_to( os, tmpl, data );
+            }
+        }
     }
     catch( ::inja::RenderError& ex )
     {
@@ -446,180 +295,434 @@ void HTMLTemplateEngine::renderTemplate( const nlohmann::json& data, TemplateTyp
     }
 }
 
-void HTMLTemplateEngine::renderPlot( const nlohmann::json& data, std::ostream& os )
+std::string HTMLTemplateEngine::runGNUPlot( const std::string& strData, const std::string& strScript ) const
+{
+    // the script is read from stdin and the svg written to stdout
+    const ProcessResult result
+        = runExternalProcess( "gnuplot", {}, gnuplotInput( strData, strScript ), m_processTimeout );
+    VERIFY_RTE_MSG( result.iExitCode == EXIT_SUCCESS, "gnuplot failed with error: " << result.strError );
+    VERIFY_RTE_MSG( result.strError.empty(), "gnuplot failed with error: " << result.strError );
+    VERIFY_RTE_MSG( !result.strOutput.empty(), "gnuplot generated no output" );
+    return result.strOutput;
+}
+
+std::string HTMLTemplateEngine::runGraphviz( const std::string& strDot ) const
+{
+#ifdef REPORT_WITH_LIBGVC
+    // laid out in memory without a process or temporary files
+    std::string strSVG;
+    rewriteSVGBookmarks( renderGraphvizSVG( strDot ), strSVG );
+    return strSVG;
+#else
+    const ProcessResult result = runExternalProcess( "dot", { "-Tsvg" }, strDot, m_processTimeout );
+    VERIFY_RTE_MSG( result.iExitCode == EXIT_SUCCESS, "Graphviz failed with error: " << result.strError );
+    VERIFY_RTE_MSG( result.strError.empty(), "Graphviz failed with error: " << result.strError );
+    VERIFY_RTE_MSG( !result.strOutput.empty(), "Graphviz generated no output" );
+
+    std::string strSVG;
+    rewriteSVGBookmarks( result.strOutput, strSVG );
+    return strSVG;
+#endif
+}
+
+bool HTMLTemplateEngine::loadCachedSVG( const std::string& strCacheKey, std::ostream& os,
+                                        const SVGFilter& filter ) const
+{
+    if( m_pSVGCache )
+    {
+        if( auto svgOpt = m_pSVGCache->load( strCacheKey ); svgOpt.has_value() )
+        {
+            os << filterSVG( filter, std::move( svgOpt.value() ) );
+            return true;
+        }
+    }
+    return false;
+}
+
+void HTMLTemplateEngine::dispatch( const std::string& strCacheKey, std::function< std::string() > job,
+                                   std::ostream& os, const SVGFilter& filter ) const
 {
+    if( loadCachedSVG( strCacheKey, os, filter ) )
+    {
+        return;
+    }
+    if( m_pSVGCache )
+    {
+        job = [ pSVGCache = m_pSVGCache, strCacheKey, job = std::move( job ) ]()
+        {
+            std::string strSVG = job();
+            pSVGCache->store( strCacheKey, strSVG );
+            return strSVG;
+        };
+    }
+
+    // the cache holds the svg itself and the filter runs with the job so a deferred result is
+    // ready as soon as the process completes
+    if( filter )
+    {
+        job = [ filter, job = std::move( job ) ]() { return filter( job() ); };
+    }
+
+    DeferredOutput* pDeferred = DeferredOutput::get( os );
+    if( m_pProcessTasks && pDeferred )
+    {
+        auto pTask = std::make_shared< std::packaged_task< std::string() > >( std::move( job ) );
+        pDeferred->defer( pTask->get_future().share() );
+        m_pProcessTasks->run( [ pTask ]() { ( *pTask )(); } );
+    }
+    else
+    {
+        os << job();
+    }
+}
+
+void HTMLTemplateEngine::setMaxProcesses( std::size_t szMaxProcesses )
+{
+    // complete any outstanding jobs before replacing the pool
+    m_pProcessTasks.reset();
+    m_pProcessPool.reset();
+    if( szMaxProcesses != 0U )
+    {
+        m_pProcessPool  = std::make_unique< ThreadPool >( szMaxProcesses );
+        m_pProcessTasks = std::make_unique< ThreadPool::TaskGroup >( *m_pProcessPool );
+    }
+}
+
+void HTMLTemplateEngine::setPlotBackend( PlotBackend plotBackend )
+{
+    m_plotBackend = plotBackend;
+    if( ( m_plotBackend == eGNUPlotCoProcess ) && !m_pGNUPlot )
+    {
+        m_pGNUPlot = std::make_unique< GNUPlot >();
+    }
+}
+
+std::string HTMLTemplateEngine::runGNUPlotCoProcess( const std::string& strData, const std::string& strScript ) const
+{
+    return m_pGNUPlot->run( gnuplotInput( strData, strScript ), m_processTimeout );
+}
+
+void HTMLTemplateEngine::renderPlot( const nlohmann::json& data, std::ostream& os, const SVGFilter& filter ) const
+{
+    if( m_plotBackend == eNativePlot )
+    {
+        std::string strSVG;
+        renderSVGPlot( data, strSVG );
+        os << filterSVG( filter, std::move( strSVG ) );
+        return;
+    }
+
     // generate the data file
+    std::ostringstream osData;
+    for( const auto& p : data[ "points" ] )
     {
-        boost::filesystem::path tempDataFile = m_tempFolder / "plot.dat";
-        auto                    pDataFile    = boost::filesystem::createNewFileStream( tempDataFile );
-        for( const auto& p : data[ "points" ] )
+        int iCount = 0;
+        for( const auto& value : p[ "values" ] )
         {
-            int iCount = 0;
-            for( const auto& value : p[ "values" ] )
+            if( iCount < 2 )
             {
-                if( iCount < 2 )
-                {
-                    *pDataFile << value.get< std::string >() << " ";
-                }
-                else
-                {
-                    *pDataFile << '\"' << value.get< std::string >() << "\" ";
-                }
-                ++iCount;
+                osData << value.get< std::string >() << " ";
             }
-            *pDataFile << "\n";
+            else
+            {
+                osData << '\"' << value.get< std::string >() << "\" ";
+            }
+            ++iCount;
         }
+        osData << "\n";
+    }
+
+    // render the template
+    std::ostringstream osGNUPlot;
+    {
+        // NOTE: an empty "output" keeps templates that still write set output {{ output }} on stdout
+        nlohmann::json scriptData = data;
+        scriptData[ "data" ]      = g_gnuplotDataBlock;
+        scriptData[ "output" ]    = "";
+        renderTemplate( scriptData, ePlot, osGNUPlot, nullptr );
     }
 
-    boost::filesystem::path tempGNUPlotFile = m_tempFolder / "plot.txt";
+    std::string strData = osData.str(), strScript = osGNUPlot.str();
+    VERIFY_RTE_MSG( !setsOutputFile( strScript ),
+                    "Plot template sets an output file but the svg must be written to stdout with: set output" );
+    std::string strCacheKey;
+    if( m_pSVGCache )
     {
-        // render the template
-        std::ostringstream osGNUPlot;
-        renderTemplate( data, ePlot, osGNUPlot );
-        // write the temporary file
+        strCacheKey = contentCacheKey( "gnuplot", { strScript, strData } );
+    }
+    if( m_plotBackend == eGNUPlotCoProcess )
+    {
+        dispatch( strCacheKey,
+                  [ this, strData = std::move( strData ), strScript = std::move( strScript ) ]()
+                  { return runGNUPlotCoProcess( strData, strScript ); },
+                  os, filter );
+    }
+    else
+    {
+        dispatch( strCacheKey,
+                  [ this, strData = std::move( strData ), strScript = std::move( strScript ) ]()
+                  { return runGNUPlot( strData, strScript ); },
+                  os, filter );
+    }
+}
+
+void HTMLTemplateEngine::renderGraph( const nlohmann::json& data, std::ostream& os, const SVGFilter& filter ) const
+{
+    if( isNativeGraph( data[ "nodes" ].size() ) )
+    {
+        std::string strSVG;
+        renderSVGGraph( data, strSVG );
+        os << filterSVG( filter, std::move( strSVG ) );
+        return;
+    }
+
+    std::ostringstream osDot;
+    renderTemplate( data, eGraph, osDot, nullptr );
+
+    std::string strDot = osDot.str();
+    std::string strCacheKey;
+    if( m_pSVGCache )
+    {
+        strCacheKey = contentCacheKey( "graphviz", { strDot } );
+    }
+
+    DeferredOutput* pDeferred = DeferredOutput::get( os );
+    if( m_bBatchGraphs && pDeferred )
+    {
+        if( !loadCachedSVG( strCacheKey, os, filter ) )
         {
-            auto pTempFile = boost::filesystem::createNewFileStream( tempGNUPlotFile );
-            *pTempFile << osGNUPlot.str();
+            std::lock_guard< std::mutex > lock( m_batchMutex );
+            GraphBatch& batch = m_graphBatches[ &pDeferred->root() ];
+            batch.push_back( BatchedGraph{ std::move( strDot ), std::move( strCacheKey ), filter, {} } );
+            pDeferred->defer( batch.back().promise.get_future().share() );
         }
     }
+    else
+    {
+        dispatch(
+            strCacheKey, [ this, strDot = std::move( strDot ) ]() { return runGraphviz( strDot ); }, os, filter );
+    }
+}
 
-    // run gnuplot
+void HTMLTemplateEngine::runGraphvizBatch( GraphBatch& batch ) const
+{
+    try
     {
-        auto currentDir = boost::filesystem::current_path();
-        boost::filesystem::current_path( m_tempFolder );
+        std::vector< std::string > svgs;
+#ifdef REPORT_WITH_LIBGVC
+        // there is no process to share so each graph is simply laid out in turn
+        for( const auto& graph : batch )
+        {
+            rewriteSVGBookmarks( renderGraphvizSVG( graph.strDot ), svgs.emplace_back() );
+        }
+#else
+        // dot lays out each graph on stdin in turn writing one svg document after another
+        std::string strDots;
+        for( const auto& graph : batch )
+        {
+            strDots.append( graph.strDot );
+            strDots.push_back( '\n' );
+        }
+        const ProcessResult result = runExternalProcess( "dot", { "-Tsvg" }, strDots, m_processTimeout );
+        VERIFY_RTE_MSG( result.iExitCode == EXIT_SUCCESS, "Graphviz failed with error: " << result.strError );
+        VERIFY_RTE_MSG( result.strError.empty(), "Graphviz failed with error: " << result.strError );
 
-        try
         {
-            std::ostringstream osCmd;
-            osCmd << "gnuplot " << tempGNUPlotFile.string();
-
-            std::string strOutput, strError;
-            const int   iExitCode = common::runProcess( osCmd.str(), strOutput, strError );
-            VERIFY_RTE_MSG( iExitCode == EXIT_SUCCESS, "gnuplot failed with error: " << strError );
-            VERIFY_RTE_MSG( strError.empty(), "gnuplot failed with error: " << strError );
-            VERIFY_RTE_MSG( strOutput.empty(), "gnuplot failed with output: " << strOutput );
+            const std::string_view        strSVGs = result.strOutput;
+            static const std::string_view strEnd  = "</svg>\n";
+            std::size_t                   szPos   = 0U;
+            for( std::size_t szEnd = strSVGs.find( strEnd ); szEnd != std::string::npos;
+                 szEnd             = strSVGs.find( strEnd, szPos ) )
+            {
+                rewriteSVGBookmarks( strSVGs.substr( szPos, szEnd + strEnd.size() - szPos ), svgs.emplace_back() );
+                szPos = szEnd + strEnd.size();
+            }
+        }
+        VERIFY_RTE_MSG( svgs.size() == batch.size(),
+                        "Graphviz generated " << svgs.size() << " svgs for " << batch.size() << " graphs" );
+#endif
+
+        if( m_pSVGCache )
+        {
+            for( std::size_t i = 0U; i != batch.size(); ++i )
+            {
+                m_pSVGCache->store( batch[ i ].strCacheKey, svgs[ i ] );
+            }
+        }
+        // NOTE: every filter runs before any promise is set so that a failure can still be set on all
+        for( std::size_t i = 0U; i != batch.size(); ++i )
+        {
+            svgs[ i ] = filterSVG( batch[ i ].filter, std::move( svgs[ i ] ) );
         }
-        catch( std::exception& ex )
+        for( std::size_t i = 0U; i != batch.size(); ++i )
         {
-            boost::filesystem::current_path( currentDir );
-            throw;
+            batch[ i ].promise.set_value( std::move( svgs[ i ] ) );
         }
+    }
+    catch( ... )
+    {
+        // the error surfaces from the DeferredOutput waiting on the graphs
+        for( auto& graph : batch )
+        {
+            graph.promise.set_exception( std::current_exception() );
+        }
+    }
+}
 
-        boost::filesystem::current_path( currentDir );
+void HTMLTemplateEngine::flushGraphBatch( const DeferredOutput& output ) const
+{
+    auto pBatch = std::make_shared< GraphBatch >();
+    {
+        std::lock_guard< std::mutex > lock( m_batchMutex );
+        auto                          iFind = m_graphBatches.find( &output.root() );
+        if( iFind == m_graphBatches.end() )
+        {
+            return;
+        }
+        std::swap( *pBatch, iFind->second );
+        m_graphBatches.erase( iFind );
     }
 
-    // load the resultant svg file
-    std::string strSVG;
+    if( m_pProcessTasks )
+    {
+        m_pProcessTasks->run( [ this, pBatch ]() { runGraphvizBatch( *pBatch ); } );
+    }
+    else
     {
-        boost::filesystem::path tempSVGFile = m_tempFolder / "plot.svg";
-        boost::filesystem::loadAsciiFile( tempSVGFile, strSVG );
+        runGraphvizBatch( *pBatch );
     }
-    os << strSVG;
 }
 
-void HTMLTemplateEngine::renderGraph( const nlohmann::json& data, std::ostream& os )
+void HTMLTemplateEngine::discardGraphBatch( const DeferredOutput& output ) const
 {
-    std::ostringstream osDot;
-    renderTemplate( data, eGraph, osDot );
+    std::lock_guard< std::mutex > lock( m_batchMutex );
+    m_graphBatches.erase( &output.root() );
+}
 
-    boost::filesystem::path tempDotFile = m_tempFolder / "temp.dot";
-    boost::filesystem::path tempSVGFile = m_tempFolder / "temp.svg";
+std::string HTMLTemplateEngine::fragmentCacheKey( const SHA256::Digest& digest, std::size_t szDepth ) const
+{
+    // the svg cache version also covers fragments as they contain the svgs
+    std::string strSettings = std::to_string( m_plotBackend ) + " " + std::to_string( m_graphBackend ) + " "
+                              + std::to_string( m_szMaxNativeNodes );
 
-    // write the temporary file
+    // a fragment refers to the svgs it stored as assets which a cached copy does not store again
+    if( m_pAssets )
     {
-        auto pTempFile = boost::filesystem::createNewFileStream( tempDotFile );
-        *pTempFile << osDot.str();
+        strSettings += " assets " + m_pAssets->getDirectory().string() + " " + m_pAssets->getURL();
     }
 
-    // run graphviz
+    // the depth of a fragment only changes its html when branches collapse by depth
+    if( ( m_szCollapseDepth != NEVER_COLLAPSE ) || ( m_szCollapseChildren != NEVER_COLLAPSE ) )
     {
-        std::ostringstream osCmd;
-        osCmd << "dot -Tsvg -o" << tempSVGFile.string() << " " << tempDotFile.string();
-
-        std::string strOutput, strError;
-        common::runProcess( osCmd.str(), strOutput, strError );
-        VERIFY_RTE_MSG( strError.empty(), "Graphviz failed with error: " << strError );
-        VERIFY_RTE_MSG( strOutput.empty(), "Graphviz failed with output: " << strOutput );
+        strSettings += " collapse " + std::to_string( m_szCollapseDepth ) + " "
+                       + std::to_string( m_szCollapseChildren ) + " "
+                       + std::to_string( std::min( szDepth, m_szCollapseDepth ) );
     }
+    return contentCacheKey( "fragment", { m_strTemplateHash, strSettings, SHA256::toHex( digest ) } );
+}
 
-    // deal with annoying graphviz behaviour with how id is generated where it doesnt work as bookmark
+void HTMLTemplateEngine::deferFragment( const DeferredOutput& output, const std::string& strCacheKey,
+                                        std::shared_future< std::string > fragment ) const
+{
+    std::lock_guard< std::mutex > lock( m_fragmentMutex );
+    m_pendingFragments[ &output.root() ].emplace_back( strCacheKey, std::move( fragment ) );
+}
 
-    std::string str;
+void HTMLTemplateEngine::storeFragments( const DeferredOutput& output ) const
+{
+    PendingFragments fragments;
     {
-        boost::filesystem::loadAsciiFile( tempSVGFile, str );
-
-        static const std::string strSearch  = "<g id=\"a_";
-        static const std::string strReplace = "<text ";
-
-        using Iter = std::string::iterator;
-
-        for( Iter i = str.begin(), iEnd = str.end(); i != iEnd;
-             i = std::search( i, iEnd, strSearch.begin(), strSearch.end() ) )
+        std::lock_guard< std::mutex > lock( m_fragmentMutex );
+        auto                          iFind = m_pendingFragments.find( &output.root() );
+        if( iFind == m_pendingFragments.end() )
         {
-            Iter r = std::search( i, iEnd, strReplace.begin(), strReplace.end() );
-            if( r != iEnd )
-            {
-                Iter idStart    = i + 2; // NOTE: include the space before the id=
-                int  quoteCount = 0;
-
-                // find the end of the id="something" by counting the quotes
-                Iter idEnd = idStart;
-                for( ; ( idEnd != iEnd ) && ( quoteCount != 2 ); )
-                {
-                    if( *idEnd == '\"' )
-                    {
-                        ++quoteCount;
-                    }
-                    ++idEnd;
-                }
+            return;
+        }
+        std::swap( fragments, iFind->second );
+        m_pendingFragments.erase( iFind );
+    }
+
+    for( const auto& [ strCacheKey, fragment ] : fragments )
+    {
+        m_pFragmentCache->store( strCacheKey, fragment.get() );
+    }
+}
 
-                // want to move the id string to 5 chars after r ( ignore the space )
-                Iter newID = r + 6;
+void HTMLTemplateEngine::discardFragments( const DeferredOutput& output ) const
+{
+    std::lock_guard< std::mutex > lock( m_fragmentMutex );
+    m_pendingFragments.erase( &output.root() );
+}
 
-                // move ( idStart to idEnd ) to newID
-                std::string strTemp( idStart, idEnd );
-                boost::replace_all( strTemp, "\"a_", "  \"" );
+void HTMLTemplateEngine::renderAsset( TemplateType templateType, const nlohmann::json& data, std::ostream& os ) const
+{
+    // bookmarks within the svg are listed so that navigating to one of them loads it.  The svg is
+    // stored and replaced by its placeholder as soon as it is generated, even when deferred.
+    const SVGFilter placeholder
+        = [ pAssets = m_pAssets, bookmarks = data.value( "bookmarks", nlohmann::json::array() ) ](
+              std::string strSVG ) { return pAssets->svgPlaceholder( strSVG, bookmarks ); };
+    ( templateType == ePlot ) ? renderPlot( data, os, placeholder ) : renderGraph( data, os, placeholder );
+}
 
-                auto iNewIDStart = std::copy( idEnd, newID, idStart );
-                std::copy( strTemp.begin(), strTemp.end(), iNewIDStart );
-            }
-        }
+void HTMLTemplateEngine::addPageAssets( nlohmann::json& data ) const
+{
+    const nlohmann::json empty = nlohmann::json::object();
+    std::ostringstream   osStyle, osScript;
+    renderTemplate( empty, eStyle, osStyle, nullptr );
+    renderTemplate( empty, eScript, osScript, nullptr );
+    if( m_pAssets )
+    {
+        data[ "has_assets" ] = true;
+        data[ "style_url" ]  = m_pAssets->store( osStyle.str(), ".css" );
+        data[ "script_url" ] = m_pAssets->store( osScript.str(), ".js" );
+    }
+    else
+    {
+        data[ "has_assets" ] = false;
+        data[ "style" ]      = osStyle.str();
+        data[ "script" ]     = osScript.str();
     }
-    os << str;
 }
 
-void HTMLTemplateEngine::render( TemplateType templateType, const nlohmann::json& data, std::ostream& os )
+void HTMLTemplateEngine::render( TemplateType templateType, const nlohmann::json& data, std::ostream& os,
+                                 TemplateSlots* pSlots ) const
 {
     switch( templateType )
     {
         case eReport:
         {
-            renderTemplate( data, eReport, os );
+            renderTemplate( data, eReport, os, pSlots );
         }
         break;
         case eMultiLine:
         {
-            renderTemplate( data, eMultiLine, os );
+            renderTemplate( data, eMultiLine, os, pSlots );
         }
         break;
         case eBranch:
         {
-            renderTemplate( data, eBranch, os );
+            renderTemplate( data, eBranch, os, pSlots );
         }
         break;
         case eTable:
         {
-            renderTemplate( data, eTable, os );
+            renderTemplate( data, eTable, os, pSlots );
         }
         break;
         case ePlot:
         {
-            renderPlot( data, os );
+            m_pAssets ? renderAsset( ePlot, data, os ) : renderPlot( data, os, {} );
         }
         break;
         case eGraph:
         {
-            renderGraph( data, os );
+            m_pAssets ? renderAsset( eGraph, data, os ) : renderGraph( data, os, {} );
+        }
+        break;
+        case eStyle:
+        case eScript:
+        {
+            renderTemplate( data, templateType, os, pSlots );
         }
         break;
         default:
@@ -0,0 +1,72 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/interned_string.hpp"
+#include "report/html_escape.hpp"
+
+#include <mutex>
+
+namespace report
+{
+
+InternedString::InternedString( std::string_view str )
+    : InternedString( StringPool::getDefault().intern( str ) )
+{
+}
+
+StringPool& StringPool::getDefault()
+{
+    // never destroyed so interned strings remain valid during static destruction
+    static StringPool* pPool = new StringPool;
+    return *pPool;
+}
+
+InternedString StringPool::intern( std::string_view str )
+{
+    {
+        std::shared_lock< std::shared_mutex > lock( m_mutex );
+        auto                                  iFind = m_index.find( str );
+        if( iFind != m_index.end() )
+        {
+            return InternedString( iFind->second );
+        }
+    }
+
+    std::unique_lock< std::shared_mutex > lock( m_mutex );
+    auto                                  iFind = m_index.find( str );
+    if( iFind != m_index.end() )
+    {
+        return InternedString( iFind->second );
+    }
+
+    // deque elements never move so the index can refer to the entry strings
+    InternedString::Entry& entry = m_entries.emplace_back();
+    entry.strValue.assign( str );
+    escapeHTML( entry.strValue, entry.strEscaped );
+    m_index.insert( { std::string_view( entry.strValue ), &entry } );
+    return InternedString( &entry );
+}
+
+std::size_t StringPool::size() const
+{
+    std::shared_lock< std::shared_mutex > lock( m_mutex );
+    return m_entries.size();
+}
+
+} // namespace report
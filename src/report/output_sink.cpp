@@ -0,0 +1,369 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/output_sink.hpp"
+
+#include "common/assert_verify.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <climits>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace report
+{
+
+OutputStream::ChunkBuffer::ChunkBuffer( OutputSink& sink, std::size_t szChunkSize, std::size_t szMaxChunks )
+    : m_sink( sink )
+    , m_szChunkSize( szChunkSize )
+{
+    VERIFY_RTE_MSG( ( szChunkSize != 0U ) && ( szChunkSize <= std::numeric_limits< int >::max() ),
+                    "Invalid output chunk size: " << szChunkSize );
+    VERIFY_RTE_MSG( szMaxChunks != 0U, "Output needs at least one chunk" );
+    m_chunks.resize( szMaxChunks );
+    m_chunks.front() = std::make_unique< char[] >( m_szChunkSize );
+    setp( m_chunks.front().get(), m_chunks.front().get() + m_szChunkSize );
+}
+
+void OutputStream::ChunkBuffer::nextChunk()
+{
+    if( m_szCurrent + 1U == m_chunks.size() )
+    {
+        flushChunks();
+        return;
+    }
+    auto& pChunk = m_chunks[ ++m_szCurrent ];
+    if( !pChunk )
+    {
+        pChunk = std::make_unique< char[] >( m_szChunkSize );
+    }
+    setp( pChunk.get(), pChunk.get() + m_szChunkSize );
+}
+
+void OutputStream::ChunkBuffer::flushChunks( std::string_view strTrailing )
+{
+    std::vector< OutputSink::Buffer > buffers;
+    buffers.reserve( m_szCurrent + 2U );
+    for( std::size_t i = 0U; i != m_szCurrent; ++i )
+    {
+        buffers.emplace_back( m_chunks[ i ].get(), m_szChunkSize );
+    }
+    if( pptr() != pbase() )
+    {
+        buffers.emplace_back( pbase(), static_cast< std::size_t >( pptr() - pbase() ) );
+    }
+    if( !strTrailing.empty() )
+    {
+        buffers.push_back( strTrailing );
+    }
+
+    // reset before writing so that a failed write is not repeated
+    m_szCurrent = 0U;
+    setp( m_chunks.front().get(), m_chunks.front().get() + m_szChunkSize );
+
+    if( !buffers.empty() )
+    {
+        m_sink.write( buffers.data(), buffers.size() );
+    }
+}
+
+std::streamsize OutputStream::ChunkBuffer::xsputn( const char* pData, std::streamsize szSize )
+{
+    const auto szTotal = static_cast< std::size_t >( szSize );
+    if( szTotal >= m_szChunkSize )
+    {
+        // large enough to write in place
+        flushChunks( std::string_view( pData, szTotal ) );
+        return szSize;
+    }
+
+    std::size_t szRemaining = szTotal;
+    while( szRemaining != 0U )
+    {
+        if( pptr() == epptr() )
+        {
+            nextChunk();
+        }
+        const std::size_t szCopy = std::min( szRemaining, static_cast< std::size_t >( epptr() - pptr() ) );
+        std::memcpy( pptr(), pData, szCopy );
+        pbump( static_cast< int >( szCopy ) );
+        pData += szCopy;
+        szRemaining -= szCopy;
+    }
+    return szSize;
+}
+
+OutputStream::ChunkBuffer::int_type OutputStream::ChunkBuffer::overflow( int_type ch )
+{
+    if( !traits_type::eq_int_type( ch, traits_type::eof() ) )
+    {
+        if( pptr() == epptr() )
+        {
+            nextChunk();
+        }
+        *pptr() = traits_type::to_char_type( ch );
+        pbump( 1 );
+    }
+    return traits_type::not_eof( ch );
+}
+
+int OutputStream::ChunkBuffer::sync()
+{
+    flushChunks();
+    return 0;
+}
+
+OutputStream::OutputStream( OutputSink& sink, std::size_t szChunkSize, std::size_t szMaxChunks )
+    : std::ostream( nullptr )
+    , m_buffer( sink, szChunkSize, szMaxChunks )
+{
+    rdbuf( &m_buffer );
+    // rethrow the sink's exceptions instead of only setting the badbit
+    exceptions( std::ios::badbit );
+}
+
+OutputStream::~OutputStream()
+{
+    // NOTE: like std::ofstream errors writing out the remaining output are ignored here so flush
+    // before destruction to see them
+    try
+    {
+        m_buffer.flushChunks();
+    }
+    catch( ... )
+    {
+    }
+}
+
+void StreamSink::write( const Buffer* pBuffers, std::size_t szCount )
+{
+    for( const Buffer* pEnd = pBuffers + szCount; pBuffers != pEnd; ++pBuffers )
+    {
+        m_os.write( pBuffers->data(), static_cast< std::streamsize >( pBuffers->size() ) );
+    }
+    VERIFY_RTE_MSG( m_os.good(), "Failed to write output stream" );
+}
+
+void StreamSink::close()
+{
+    m_os.flush();
+    VERIFY_RTE_MSG( m_os.good(), "Failed to flush output stream" );
+}
+
+#ifndef _WIN32
+namespace
+{
+// writes all of the buffers with as few calls to writeVector as possible resuming after partial writes
+template < typename WriteVector >
+void writeAll( const OutputSink::Buffer* pBuffers, std::size_t szCount, WriteVector&& writeVector )
+{
+    std::vector< iovec > vectors;
+    vectors.reserve( std::min< std::size_t >( szCount, IOV_MAX ) );
+
+    std::size_t szOffset = 0U; // already written from the first buffer
+    while( szCount != 0U )
+    {
+        vectors.clear();
+        for( std::size_t i = 0U; ( i != szCount ) && ( vectors.size() != IOV_MAX ); ++i )
+        {
+            const std::size_t szSkip = ( i == 0U ) ? szOffset : 0U;
+            vectors.push_back( iovec{ const_cast< char* >( pBuffers[ i ].data() ) + szSkip,
+                                      pBuffers[ i ].size() - szSkip } );
+        }
+
+        const ssize_t szWritten = writeVector( vectors.data(), static_cast< int >( vectors.size() ) );
+        if( szWritten < 0 )
+        {
+            VERIFY_RTE_MSG( errno == EINTR, "Failed to write output: " << std::strerror( errno ) );
+            continue;
+        }
+
+        // skip past everything written
+        auto szRemaining = static_cast< std::size_t >( szWritten );
+        while( ( szCount != 0U ) && ( szRemaining >= pBuffers->size() - szOffset ) )
+        {
+            szRemaining -= pBuffers->size() - szOffset;
+            szOffset = 0U;
+            ++pBuffers;
+            --szCount;
+        }
+        szOffset += szRemaining;
+    }
+}
+} // namespace
+#endif
+
+FileSink::FileSink( const boost::filesystem::path& filePath )
+    : m_filePath( filePath )
+{
+#ifdef _WIN32
+    m_pFile = std::fopen( m_filePath.string().c_str(), "wb" );
+    VERIFY_RTE_MSG( m_pFile, "Failed to create file: " << m_filePath.string() );
+#else
+    m_iFile = ::open( m_filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644 );
+    VERIFY_RTE_MSG( m_iFile != -1, "Failed to create file: " << m_filePath.string() << " " << std::strerror( errno ) );
+#endif
+}
+
+FileSink::~FileSink()
+{
+#ifdef _WIN32
+    if( m_pFile )
+    {
+        std::fclose( m_pFile );
+    }
+#else
+    if( m_iFile != -1 )
+    {
+        ::close( m_iFile );
+    }
+#endif
+}
+
+void FileSink::write( const Buffer* pBuffers, std::size_t szCount )
+{
+#ifdef _WIN32
+    VERIFY_RTE_MSG( m_pFile, "Write to closed file: " << m_filePath.string() );
+    for( const Buffer* pEnd = pBuffers + szCount; pBuffers != pEnd; ++pBuffers )
+    {
+        VERIFY_RTE_MSG( std::fwrite( pBuffers->data(), 1U, pBuffers->size(), m_pFile ) == pBuffers->size(),
+                        "Failed to write file: " << m_filePath.string() );
+    }
+#else
+    VERIFY_RTE_MSG( m_iFile != -1, "Write to closed file: " << m_filePath.string() );
+    writeAll( pBuffers, szCount,
+              [ iFile = m_iFile ]( const iovec* pVectors, int iCount )
+              { return ::writev( iFile, pVectors, iCount ); } );
+#endif
+}
+
+void FileSink::close()
+{
+#ifdef _WIN32
+    if( m_pFile )
+    {
+        const int iResult = std::fclose( m_pFile );
+        m_pFile           = nullptr;
+        VERIFY_RTE_MSG( iResult == 0, "Failed to close file: " << m_filePath.string() );
+    }
+#else
+    if( m_iFile != -1 )
+    {
+        const int iResult = ::close( m_iFile );
+        m_iFile           = -1;
+        VERIFY_RTE_MSG(
+            iResult == 0, "Failed to close file: " << m_filePath.string() << " " << std::strerror( errno ) );
+    }
+#endif
+}
+
+#ifndef _WIN32
+void SocketSink::write( const Buffer* pBuffers, std::size_t szCount )
+{
+    writeAll( pBuffers, szCount,
+              [ iSocket = m_iSocket ]( iovec* pVectors, int iCount )
+              {
+                  msghdr message{};
+                  message.msg_iov    = pVectors;
+                  message.msg_iovlen = iCount;
+                  return ::sendmsg( iSocket, &message, MSG_NOSIGNAL );
+              } );
+}
+#endif
+
+#ifdef REPORT_WITH_ZLIB
+namespace
+{
+static const std::size_t g_szGZipOutputSize = 64U * 1024U;
+}
+
+GZipSink::GZipSink( OutputSink& target, int iLevel )
+    : m_target( target )
+    , m_pOutput( std::make_unique< char[] >( g_szGZipOutputSize ) )
+{
+    // NOTE: 16 added to the window bits selects the gzip format
+    VERIFY_RTE_MSG( deflateInit2( &m_stream, iLevel, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY ) == Z_OK,
+                    "Failed to initialise zlib" );
+}
+
+GZipSink::~GZipSink()
+{
+    deflateEnd( &m_stream );
+}
+
+void GZipSink::compress( Buffer buffer, int iFlush )
+{
+    do
+    {
+        // zlib lengths are 32 bit so larger buffers are passed in pieces
+        const std::size_t szInput = std::min< std::size_t >( buffer.size(), std::numeric_limits< uInt >::max() );
+        m_stream.next_in          = reinterpret_cast< Bytef* >( const_cast< char* >( buffer.data() ) );
+        m_stream.avail_in         = static_cast< uInt >( szInput );
+        buffer.remove_prefix( szInput );
+        const int iPieceFlush = buffer.empty() ? iFlush : Z_NO_FLUSH;
+
+        int iResult = Z_OK;
+        do
+        {
+            m_stream.next_out  = reinterpret_cast< Bytef* >( m_pOutput.get() );
+            m_stream.avail_out = static_cast< uInt >( g_szGZipOutputSize );
+            iResult            = ::deflate( &m_stream, iPieceFlush );
+            VERIFY_RTE_MSG( ( iResult == Z_OK ) || ( iResult == Z_STREAM_END ) || ( iResult == Z_BUF_ERROR ),
+                            "zlib failed to compress output: " << iResult );
+
+            const Buffer compressed( m_pOutput.get(), g_szGZipOutputSize - m_stream.avail_out );
+            if( !compressed.empty() )
+            {
+                m_target.write( &compressed, 1U );
+            }
+        } while( ( m_stream.avail_out == 0U ) || ( ( iPieceFlush == Z_FINISH ) && ( iResult != Z_STREAM_END ) ) );
+    } while( !buffer.empty() );
+}
+
+void GZipSink::write( const Buffer* pBuffers, std::size_t szCount )
+{
+    VERIFY_RTE_MSG( !m_bClosed, "Write to closed gzip output" );
+    for( const Buffer* pEnd = pBuffers + szCount; pBuffers != pEnd; ++pBuffers )
+    {
+        compress( *pBuffers, Z_NO_FLUSH );
+    }
+}
+
+void GZipSink::close()
+{
+    if( !m_bClosed )
+    {
+        m_bClosed = true;
+        compress( {}, Z_FINISH );
+        m_target.close();
+    }
+}
+#endif
+
+} // namespace report
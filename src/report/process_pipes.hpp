@@ -0,0 +1,64 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#ifndef GUARD_2024_March_27_process_pipes
+#define GUARD_2024_March_27_process_pipes
+
+#include <boost/asio/io_context.hpp>
+#include <boost/process/async_pipe.hpp>
+
+#include <mutex>
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+// NOTE: private to the report library so that including external_process.hpp does not pull in
+// boost.process and asio
+namespace report
+{
+
+// Process wide lock to hold while creating the pipes for and starting any child process.  Pipes
+// from createPipe are close on exec so while the lock is held no other child started concurrently
+// can inherit them, which would hold a pipe open after its own child had closed it.
+std::unique_lock< std::mutex > lockProcessStart();
+boost::process::async_pipe     createPipe( boost::asio::io_context& ioContext );
+
+// Blocks SIGPIPE for the calling thread while it writes to a child process that may already have
+// exited, discarding any raised, so that the failure surfaces from the child instead of killing
+// this process.
+class SigPipeGuard
+{
+public:
+    SigPipeGuard();
+    ~SigPipeGuard();
+
+    SigPipeGuard( const SigPipeGuard& )            = delete;
+    SigPipeGuard& operator=( const SigPipeGuard& ) = delete;
+
+private:
+#ifndef _WIN32
+    sigset_t m_previous;
+    bool     m_bWasPending = false;
+#endif
+};
+
+} // namespace report
+
+#endif // GUARD_2024_March_27_process_pipes
@@ -0,0 +1,134 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/svg_bookmarks.hpp"
+
+#include <algorithm>
+
+namespace report
+{
+namespace
+{
+// NOTE: neither tag contains a second '<' so a failed match can never overlap another
+static const std::string_view g_strGroup = "<g id=\"a_";
+static const std::string_view g_strText  = "<text ";
+
+// length of the longest suffix of str that is a proper prefix of strTag
+std::size_t partialMatch( std::string_view str, std::string_view strTag )
+{
+    const std::size_t szFrom = str.size() - std::min( str.size(), strTag.size() - 1U );
+    const std::size_t szPos  = str.rfind( '<' );
+    if( ( szPos != std::string_view::npos ) && ( szPos >= szFrom )
+        && ( strTag.compare( 0U, str.size() - szPos, str.substr( szPos ) ) == 0 ) )
+    {
+        return str.size() - szPos;
+    }
+    return 0U;
+}
+} // namespace
+
+void SVGBookmarkRewriter::write( std::string_view str )
+{
+    while( !str.empty() )
+    {
+        if( m_state == eReadID )
+        {
+            const std::size_t szQuote = str.find( '\"' );
+            m_strID.append( str.substr( 0U, szQuote ) );
+            if( szQuote == std::string_view::npos )
+            {
+                return;
+            }
+            str.remove_prefix( szQuote + 1U );
+            m_state = eFindText;
+            continue;
+        }
+
+        const std::string_view strTag = ( m_state == eFindGroup ) ? g_strGroup : g_strText;
+        if( m_szMatched != 0U )
+        {
+            // complete a tag split between writes
+            const std::size_t szLength = std::min( strTag.size() - m_szMatched, str.size() );
+            if( strTag.compare( m_szMatched, szLength, str.substr( 0U, szLength ) ) != 0 )
+            {
+                m_strOutput.append( strTag.substr( 0U, m_szMatched ) );
+                m_szMatched = 0U;
+                continue;
+            }
+            m_szMatched += szLength;
+            str.remove_prefix( szLength );
+            if( m_szMatched != strTag.size() )
+            {
+                return;
+            }
+        }
+        else if( const std::size_t szPos = str.find( strTag ); szPos != std::string_view::npos )
+        {
+            m_strOutput.append( str.substr( 0U, szPos ) );
+            str.remove_prefix( szPos + strTag.size() );
+        }
+        else
+        {
+            // hold back the start of a tag that may continue in the next write
+            m_szMatched = partialMatch( str, strTag );
+            m_strOutput.append( str.substr( 0U, str.size() - m_szMatched ) );
+            return;
+        }
+
+        // a whole tag has been matched
+        m_szMatched = 0U;
+        if( m_state == eFindGroup )
+        {
+            // drop the id from the group
+            m_strOutput.append( "<g" );
+            m_strID.clear();
+            m_state = eReadID;
+        }
+        else
+        {
+            m_strOutput.append( "<text id=\"" );
+            m_strOutput.append( m_strID );
+            m_strOutput.append( "\" " );
+            m_state = eFindGroup;
+        }
+    }
+}
+
+void SVGBookmarkRewriter::finish()
+{
+    // NOTE: a bookmark with no following text is dropped
+    if( m_state != eReadID )
+    {
+        const std::string_view strTag = ( m_state == eFindGroup ) ? g_strGroup : g_strText;
+        m_strOutput.append( strTag.substr( 0U, m_szMatched ) );
+    }
+    m_state     = eFindGroup;
+    m_szMatched = 0U;
+    m_strID.clear();
+}
+
+void rewriteSVGBookmarks( std::string_view strSVG, std::string& strOutput )
+{
+    strOutput.reserve( strOutput.size() + strSVG.size() );
+    SVGBookmarkRewriter rewriter( strOutput );
+    rewriter.write( strSVG );
+    rewriter.finish();
+}
+
+} // namespace report
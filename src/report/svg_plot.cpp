@@ -0,0 +1,347 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/svg_plot.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace report
+{
+namespace
+{
+
+// matches set terminal svg size 600,400 in plot.jinja
+static const double g_width        = 600.0;
+static const double g_height       = 400.0;
+static const double g_marginLeft   = 80.0;
+static const double g_marginRight  = 20.0;
+static const double g_marginTop    = 45.0;
+static const double g_marginBottom = 55.0;
+static const int    g_targetTicks  = 6;
+static const char*  g_colour       = "blue";
+
+struct Point
+{
+    double             x, y;
+    const std::string* pLabel;
+};
+
+struct Axis
+{
+    double min, max, step;
+
+    double scale( double value, double from, double to ) const
+    {
+        return from + ( value - min ) / ( max - min ) * ( to - from );
+    }
+
+    // ticks are counted rather than stepped to so that a step below the precision of the values still ends
+    int    ticks() const { return static_cast< int >( std::lround( ( max - min ) / step ) ); }
+    double tick( int iTick ) const { return min + iTick * step; }
+};
+
+// returns nothing unless str is a finite number
+inline std::optional< double > parseNumber( const std::string& str )
+{
+    const char*  pStart = str.c_str();
+    char*        pEnd   = nullptr;
+    const double value  = std::strtod( pStart, &pEnd );
+    if( ( pEnd == pStart ) || !std::isfinite( value ) )
+    {
+        return std::nullopt;
+    }
+    return value;
+}
+
+// rounds range / ticks to 1, 2 or 5 times a power of ten and extends the range to whole steps
+Axis niceAxis( double min, double max )
+{
+    if( max <= min )
+    {
+        const double pad = ( min == 0.0 ) ? 1.0 : std::abs( min ) * 0.5;
+        min -= pad;
+        max += pad;
+    }
+    // a range too narrow to hold distinct ticks at the magnitude of its values is widened until it can
+    const double minRange = std::max( std::abs( min ), std::abs( max ) ) * std::numeric_limits< double >::epsilon()
+                            * 64.0 * g_targetTicks;
+    if( max - min < minRange )
+    {
+        const double middle = min + ( max - min ) * 0.5;
+        min                 = middle - minRange * 0.5;
+        max                 = middle + minRange * 0.5;
+    }
+    const double rough     = ( max - min ) / g_targetTicks;
+    const double magnitude = std::pow( 10.0, std::floor( std::log10( rough ) ) );
+    const double fraction  = rough / magnitude;
+
+    double step = magnitude * 10.0;
+    for( double nice : { 1.0, 2.0, 5.0 } )
+    {
+        if( fraction <= nice )
+        {
+            step = magnitude * nice;
+            break;
+        }
+    }
+    return Axis{ std::floor( min / step ) * step, std::ceil( max / step ) * step, step };
+}
+
+void appendNumber( std::string& str, double value, const char* pszFormat = "%.1f" )
+{
+    char      buffer[ 32 ];
+    const int iLength = std::snprintf( buffer, sizeof( buffer ), pszFormat, value );
+    str.append( buffer, static_cast< std::size_t >( iLength ) );
+}
+
+void appendTickLabel( std::string& str, double value, double step )
+{
+    // enough decimal places to distinguish the ticks
+    const int iDecimals = std::max( 0, -static_cast< int >( std::floor( std::log10( step ) + 1e-9 ) ) );
+    char      format[ 8 ];
+    std::snprintf( format, sizeof( format ), "%%.%df", std::min( iDecimals, 9 ) );
+    appendNumber( str, std::abs( value ) < step * 1e-9 ? 0.0 : value, format );
+}
+
+void appendTitle( std::string& str, const Point& point )
+{
+    if( point.pLabel )
+    {
+        str.append( "<title>" );
+        str.append( *point.pLabel );
+        str.append( "</title>" );
+    }
+}
+
+} // namespace
+
+void renderSVGPlot( const nlohmann::json& data, std::string& strOutput )
+{
+    const nlohmann::json& style    = data[ "style" ];
+    const bool            bBars    = style[ "bars" ].get< bool >();
+    const bool            bLines   = style[ "lines" ].get< bool >();
+    const bool            bScatter = style[ "scatter" ].get< bool >();
+
+    std::vector< Point > points;
+    {
+        const nlohmann::json& dataPoints = data[ "points" ];
+        points.reserve( dataPoints.size() );
+        for( const auto& dataPoint : dataPoints )
+        {
+            const nlohmann::json& values = dataPoint[ "values" ];
+            if( values.size() < 2U )
+            {
+                continue;
+            }
+            const std::optional< double > y = parseNumber( values[ 1 ].get_ref< const std::string& >() );
+            if( !y.has_value() )
+            {
+                continue;
+            }
+            const std::optional< double > x     = parseNumber( values[ 0 ].get_ref< const std::string& >() );
+            const double                  index = static_cast< double >( points.size() );
+            Point                         point{ x.value_or( index ), y.value(), nullptr };
+            if( values.size() > 2U )
+            {
+                point.pLabel = &values[ 2 ].get_ref< const std::string& >();
+            }
+            points.push_back( point );
+        }
+    }
+
+    // bars start from zero and are given half a slot either side
+    double xMin = 0.0, xMax = 1.0, yMin = 0.0, yMax = 1.0, barWidth = 0.75;
+    if( !points.empty() )
+    {
+        const auto [ xLow, xHigh ] = std::minmax_element(
+            points.begin(), points.end(), []( const Point& l, const Point& r ) { return l.x < r.x; } );
+        const auto [ yLow, yHigh ] = std::minmax_element(
+            points.begin(), points.end(), []( const Point& l, const Point& r ) { return l.y < r.y; } );
+        xMin = xLow->x;
+        xMax = xHigh->x;
+        yMin = yLow->y;
+        yMax = yHigh->y;
+        if( bBars )
+        {
+            const double slot = ( points.size() > 1U ) ? ( xMax - xMin ) / ( points.size() - 1U ) : 1.0;
+            barWidth          = slot * 0.75;
+            xMin -= slot * 0.5;
+            xMax += slot * 0.5;
+            yMin = std::min( yMin, 0.0 );
+            yMax = std::max( yMax, 0.0 );
+        }
+    }
+    const Axis xAxis = niceAxis( xMin, xMax );
+    const Axis yAxis = niceAxis( yMin, yMax );
+
+    const double left = g_marginLeft, right = g_width - g_marginRight;
+    const double top = g_marginTop, bottom = g_height - g_marginBottom;
+    const auto   xPos = [ & ]( double x ) { return xAxis.scale( x, left, right ); };
+    const auto   yPos = [ & ]( double y ) { return yAxis.scale( y, bottom, top ); };
+
+    std::string& str = strOutput;
+    str.reserve( str.size() + 2048U + points.size() * 128U );
+
+    str.append( "<svg width=\"600\" height=\"400\" viewBox=\"0 0 600 400\" xmlns=\"http://www.w3.org/2000/svg\" "
+                "font-family=\"arial\" font-size=\"10\">\n" );
+
+    // title
+    str.append( "<text x=\"300\" y=\"25\" text-anchor=\"middle\" font-size=\"20\">" );
+    {
+        bool bFirst = true;
+        for( const auto& heading : data[ "headings" ] )
+        {
+            if( !bFirst )
+            {
+                str.push_back( ' ' );
+            }
+            str.append( heading.get_ref< const std::string& >() );
+            bFirst = false;
+        }
+    }
+    str.append( "</text>\n" );
+
+    // grid, ticks and tick labels
+    str.append( "<g stroke=\"#e0e0e0\" stroke-width=\"0.5\">\n" );
+    for( int iTick = 0; iTick <= yAxis.ticks(); ++iTick )
+    {
+        const double y = yAxis.tick( iTick );
+        str.append( "<line x1=\"" );
+        appendNumber( str, left );
+        str.append( "\" x2=\"" );
+        appendNumber( str, right );
+        str.append( "\" y1=\"" );
+        appendNumber( str, yPos( y ) );
+        str.append( "\" y2=\"" );
+        appendNumber( str, yPos( y ) );
+        str.append( "\"/>\n" );
+    }
+    str.append( "</g>\n<g text-anchor=\"end\">\n" );
+    for( int iTick = 0; iTick <= yAxis.ticks(); ++iTick )
+    {
+        const double y = yAxis.tick( iTick );
+        str.append( "<text x=\"" );
+        appendNumber( str, left - 6.0 );
+        str.append( "\" y=\"" );
+        appendNumber( str, yPos( y ) + 3.5 );
+        str.append( "\">" );
+        appendTickLabel( str, y, yAxis.step );
+        str.append( "</text>\n" );
+    }
+    str.append( "</g>\n<g text-anchor=\"middle\">\n" );
+    for( int iTick = 0; iTick <= xAxis.ticks(); ++iTick )
+    {
+        const double x = xAxis.tick( iTick );
+        str.append( "<text x=\"" );
+        appendNumber( str, xPos( x ) );
+        str.append( "\" y=\"" );
+        appendNumber( str, bottom + 15.0 );
+        str.append( "\">" );
+        appendTickLabel( str, x, xAxis.step );
+        str.append( "</text>\n" );
+    }
+    str.append( "</g>\n" );
+
+    // axes and axis labels
+    str.append( "<rect x=\"" );
+    appendNumber( str, left );
+    str.append( "\" y=\"" );
+    appendNumber( str, top );
+    str.append( "\" width=\"" );
+    appendNumber( str, right - left );
+    str.append( "\" height=\"" );
+    appendNumber( str, bottom - top );
+    str.append( "\" fill=\"none\" stroke=\"black\"/>\n" );
+    str.append( "<text x=\"" );
+    appendNumber( str, ( left + right ) * 0.5 );
+    str.append( "\" y=\"" );
+    appendNumber( str, g_height - 12.0 );
+    str.append( "\" text-anchor=\"middle\">Execution Date</text>\n" );
+    str.append( "<text transform=\"translate(18," );
+    appendNumber( str, ( top + bottom ) * 0.5 );
+    str.append( ") rotate(-90)\" text-anchor=\"middle\">Benchmark Time ( ns )</text>\n" );
+
+    // series
+    if( bLines && !points.empty() )
+    {
+        str.append( "<polyline fill=\"none\" stroke=\"" );
+        str.append( g_colour );
+        str.append( "\" stroke-width=\"1.5\" points=\"" );
+        for( const Point& point : points )
+        {
+            appendNumber( str, xPos( point.x ) );
+            str.push_back( ',' );
+            appendNumber( str, yPos( point.y ) );
+            str.push_back( ' ' );
+        }
+        str.append( "\"/>\n" );
+    }
+    if( bBars )
+    {
+        str.append( "<g fill=\"" );
+        str.append( g_colour );
+        str.append( "\" fill-opacity=\"0.5\" stroke=\"" );
+        str.append( g_colour );
+        str.append( "\">\n" );
+        const double zero = yPos( 0.0 );
+        for( const Point& point : points )
+        {
+            const double y = yPos( point.y );
+            str.append( "<rect x=\"" );
+            appendNumber( str, xPos( point.x - barWidth * 0.5 ) );
+            str.append( "\" y=\"" );
+            appendNumber( str, std::min( y, zero ) );
+            str.append( "\" width=\"" );
+            appendNumber( str, xPos( point.x + barWidth * 0.5 ) - xPos( point.x - barWidth * 0.5 ) );
+            str.append( "\" height=\"" );
+            appendNumber( str, std::abs( zero - y ) );
+            str.append( "\">" );
+            appendTitle( str, point );
+            str.append( "</rect>\n" );
+        }
+        str.append( "</g>\n" );
+    }
+    if( bLines || bScatter )
+    {
+        str.append( "<g fill=\"" );
+        str.append( g_colour );
+        str.append( "\">\n" );
+        for( const Point& point : points )
+        {
+            str.append( "<circle cx=\"" );
+            appendNumber( str, xPos( point.x ) );
+            str.append( "\" cy=\"" );
+            appendNumber( str, yPos( point.y ) );
+            str.append( "\" r=\"3\">" );
+            appendTitle( str, point );
+            str.append( "</circle>\n" );
+        }
+        str.append( "</g>\n" );
+    }
+
+    str.append( "</svg>\n" );
+}
+
+} // namespace report
@@ -0,0 +1,215 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace report
+{
+namespace
+{
+// identifies the pool and queue of the current worker thread
+thread_local const ThreadPool* t_pPool       = nullptr;
+thread_local std::size_t       t_szQueueIndex = 0U;
+} // namespace
+
+ThreadPool::ThreadPool( std::size_t szThreads )
+{
+    if( szThreads == 0U )
+    {
+        szThreads = std::max( 1U, std::thread::hardware_concurrency() );
+    }
+
+    for( std::size_t i = 0U; i != szThreads + 1U; ++i )
+    {
+        m_queues.push_back( std::make_unique< Queue >() );
+    }
+    for( std::size_t i = 0U; i != szThreads; ++i )
+    {
+        m_threads.emplace_back( [ this, i ]() { worker( i ); } );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        m_bStop = true;
+    }
+    m_condition.notify_all();
+    for( auto& thread : m_threads )
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::push( Task task )
+{
+    const std::size_t szQueue = ( t_pPool == this ) ? t_szQueueIndex : m_queues.size() - 1U;
+    {
+        Queue&                        queue = *m_queues[ szQueue ];
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        queue.tasks.push_back( std::move( task ) );
+    }
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        ++m_szQueued;
+    }
+    m_condition.notify_one();
+}
+
+bool ThreadPool::runOne()
+{
+    Task task;
+
+    const std::size_t szQueues = m_queues.size();
+    const std::size_t szSelf   = ( t_pPool == this ) ? t_szQueueIndex : szQueues - 1U;
+
+    // pop the most recent local task
+    {
+        Queue&                        queue = *m_queues[ szSelf ];
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        if( !queue.tasks.empty() )
+        {
+            task = std::move( queue.tasks.back() );
+            queue.tasks.pop_back();
+        }
+    }
+
+    // otherwise steal the oldest task from another queue
+    for( std::size_t i = 1U; !task && ( i != szQueues ); ++i )
+    {
+        Queue&                        queue = *m_queues[ ( szSelf + i ) % szQueues ];
+        std::lock_guard< std::mutex > lock( queue.mutex );
+        if( !queue.tasks.empty() )
+        {
+            task = std::move( queue.tasks.front() );
+            queue.tasks.pop_front();
+        }
+    }
+
+    if( task )
+    {
+        --m_szQueued;
+        task();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::worker( std::size_t szIndex )
+{
+    t_pPool        = this;
+    t_szQueueIndex = szIndex;
+
+    while( true )
+    {
+        if( runOne() )
+        {
+            continue;
+        }
+
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_condition.wait( lock, [ this ]() { return m_bStop || ( m_szQueued != 0U ); } );
+        if( m_bStop && ( m_szQueued == 0U ) )
+        {
+            return;
+        }
+    }
+}
+
+ThreadPool::TaskGroup::~TaskGroup()
+{
+    // never leave tasks referencing a destroyed group
+    waitAll();
+}
+
+void ThreadPool::TaskGroup::run( Task task )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        ++m_szPending;
+    }
+    m_pool.push(
+        [ this, task = std::move( task ) ]()
+        {
+            std::exception_ptr pException;
+            try
+            {
+                task();
+            }
+            catch( ... )
+            {
+                pException = std::current_exception();
+            }
+
+            // NOTE: notify while holding the lock so the group cannot be destroyed beforehand
+            std::lock_guard< std::mutex > lock( m_mutex );
+            if( pException && !m_pException )
+            {
+                m_pException = pException;
+            }
+            if( --m_szPending == 0U )
+            {
+                m_condition.notify_all();
+            }
+        } );
+}
+
+void ThreadPool::TaskGroup::waitAll()
+{
+    while( true )
+    {
+        {
+            std::lock_guard< std::mutex > lock( m_mutex );
+            if( m_szPending == 0U )
+            {
+                return;
+            }
+        }
+
+        // help out rather than block
+        if( m_pool.runOne() )
+        {
+            continue;
+        }
+
+        std::unique_lock< std::mutex > lock( m_mutex );
+        m_condition.wait_for( lock, std::chrono::milliseconds( 1 ), [ this ]() { return m_szPending == 0U; } );
+    }
+}
+
+void ThreadPool::TaskGroup::wait()
+{
+    waitAll();
+
+    std::exception_ptr pException;
+    {
+        std::lock_guard< std::mutex > lock( m_mutex );
+        std::swap( pException, m_pException );
+    }
+    if( pException )
+    {
+        std::rethrow_exception( pException );
+    }
+}
+
+} // namespace report
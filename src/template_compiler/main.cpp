@@ -0,0 +1,670 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+// report_template_compiler
+//
+// Translates the subset of jinja used by the report templates into C++ functions
+// that write directly to a std::ostream.  The generated code reproduces the inja
+// rendering semantics used by HTMLTemplateEngine ( trim_blocks enabled ) for:
+//
+//      {{ path.to.value }}
+//      {% for var in path.to.array %} ... {% endfor %}
+//      {% if path.to.value %} ... {% else %} ... {% endif %}
+//      {# comment #}
+//
+// Printing a report::TemplateSlots placeholder writes the slot content in place.
+//
+// Anything else is rejected so that the build fails rather than silently
+// generating an emitter that differs from the interpreted template.
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Node
+{
+    using Ptr    = std::unique_ptr< Node >;
+    using Vector = std::vector< Ptr >;
+
+    enum Type
+    {
+        eText,
+        ePrint,
+        eFor,
+        eIf
+    };
+
+    Type                       type;
+    std::string                strText;
+    std::vector< std::string > path;
+    std::string                strLoopVariable;
+    Vector                     body;
+    Vector                     elseBody;
+};
+
+class Parser
+{
+public:
+    Parser( const std::string& strName, const std::string& strSource )
+        : m_strName( strName )
+        , m_strSource( strSource )
+    {
+    }
+
+    Node::Vector parse()
+    {
+        Node::Vector result;
+        std::string  strTerminator = parseBlock( result );
+        if( !strTerminator.empty() )
+        {
+            error( "Unexpected {% " + strTerminator + " %}" );
+        }
+        return result;
+    }
+
+private:
+    [[noreturn]] void error( const std::string& strMsg ) const
+    {
+        std::size_t szLine = 1;
+        for( std::size_t i = 0; i != m_szPos && i != m_strSource.size(); ++i )
+        {
+            if( m_strSource[ i ] == '\n' )
+                ++szLine;
+        }
+        std::ostringstream os;
+        os << m_strName << ":" << szLine << ": " << strMsg;
+        throw std::runtime_error( os.str() );
+    }
+
+    static bool isIdentifier( const std::string& str )
+    {
+        if( str.empty() || !( std::isalpha( str.front() ) || str.front() == '_' ) )
+            return false;
+        for( char c : str )
+        {
+            if( !( std::isalnum( c ) || c == '_' ) )
+                return false;
+        }
+        return true;
+    }
+
+    std::vector< std::string > parsePath( const std::string& strExpression ) const
+    {
+        std::vector< std::string > path;
+        boost::split( path, strExpression, boost::is_any_of( "." ) );
+        for( const auto& strPart : path )
+        {
+            const bool bIndex = !strPart.empty() && std::all_of( strPart.begin(), strPart.end(), ::isdigit );
+            if( !bIndex && !isIdentifier( strPart ) )
+            {
+                error( "Unsupported expression: " + strExpression );
+            }
+        }
+        if( path.front() == "loop" )
+        {
+            error( "Unsupported loop variable: " + strExpression );
+        }
+        return path;
+    }
+
+    // inja trim_blocks: skip trailing spaces and the first newline after a block
+    void trimBlock()
+    {
+        while( m_szPos < m_strSource.size() && ( m_strSource[ m_szPos ] == ' ' || m_strSource[ m_szPos ] == '\t' ) )
+            ++m_szPos;
+        if( m_szPos < m_strSource.size() )
+        {
+            if( m_strSource[ m_szPos ] == '\n' )
+            {
+                ++m_szPos;
+            }
+            else if( m_strSource[ m_szPos ] == '\r' )
+            {
+                ++m_szPos;
+                if( m_szPos < m_strSource.size() && m_strSource[ m_szPos ] == '\n' )
+                    ++m_szPos;
+            }
+        }
+    }
+
+    std::string readTag( const std::string& strClose )
+    {
+        const std::size_t szStart = m_szPos + 2;
+        const std::size_t szEnd   = m_strSource.find( strClose, szStart );
+        if( szEnd == std::string::npos )
+        {
+            error( "Unterminated tag" );
+        }
+        std::string strContent = m_strSource.substr( szStart, szEnd - szStart );
+        if( !strContent.empty() && ( strContent.front() == '-' || strContent.back() == '-' ) )
+        {
+            error( "Unsupported whitespace control in tag" );
+        }
+        m_szPos = szEnd + strClose.size();
+        boost::trim( strContent );
+        return strContent;
+    }
+
+    void addText( Node::Vector& nodes, const std::string& strText )
+    {
+        if( strText.empty() )
+            return;
+        // inja treats lines beginning with ## as line statements
+        for( std::size_t szLine = 0; szLine != std::string::npos; )
+        {
+            const std::size_t szContent = strText.find_first_not_of( " \t", szLine );
+            if( szContent != std::string::npos && strText.compare( szContent, 2, "##" ) == 0 )
+            {
+                error( "Unsupported line statement" );
+            }
+            szLine = strText.find( '\n', szLine );
+            if( szLine != std::string::npos )
+                ++szLine;
+        }
+        if( !nodes.empty() && nodes.back()->type == Node::eText )
+        {
+            nodes.back()->strText += strText;
+        }
+        else
+        {
+            auto pNode     = std::make_unique< Node >();
+            pNode->type    = Node::eText;
+            pNode->strText = strText;
+            nodes.push_back( std::move( pNode ) );
+        }
+    }
+
+    // parses until end of input or an {% end... %} / {% else %} which is returned
+    std::string parseBlock( Node::Vector& nodes )
+    {
+        while( m_szPos < m_strSource.size() )
+        {
+            const std::size_t szTag = m_strSource.find( '{', m_szPos );
+            if( szTag == std::string::npos || szTag + 1 == m_strSource.size() )
+            {
+                addText( nodes, m_strSource.substr( m_szPos ) );
+                m_szPos = m_strSource.size();
+                break;
+            }
+
+            const char cNext = m_strSource[ szTag + 1 ];
+            if( cNext != '{' && cNext != '%' && cNext != '#' )
+            {
+                addText( nodes, m_strSource.substr( m_szPos, szTag + 1 - m_szPos ) );
+                m_szPos = szTag + 1;
+                continue;
+            }
+
+            addText( nodes, m_strSource.substr( m_szPos, szTag - m_szPos ) );
+            m_szPos = szTag;
+
+            if( cNext == '#' )
+            {
+                readTag( "#}" );
+                trimBlock();
+            }
+            else if( cNext == '{' )
+            {
+                auto pNode  = std::make_unique< Node >();
+                pNode->type = Node::ePrint;
+                pNode->path = parsePath( readTag( "}}" ) );
+                nodes.push_back( std::move( pNode ) );
+            }
+            else
+            {
+                const std::string strStatement = readTag( "%}" );
+                trimBlock();
+
+                std::vector< std::string > tokens;
+                boost::split( tokens, strStatement, boost::is_space(), boost::token_compress_on );
+
+                if( tokens.size() == 4 && tokens[ 0 ] == "for" && tokens[ 2 ] == "in" )
+                {
+                    if( !isIdentifier( tokens[ 1 ] ) )
+                    {
+                        error( "Unsupported loop variable: " + tokens[ 1 ] );
+                    }
+                    auto pNode             = std::make_unique< Node >();
+                    pNode->type            = Node::eFor;
+                    pNode->strLoopVariable = tokens[ 1 ];
+                    pNode->path            = parsePath( tokens[ 3 ] );
+                    if( parseBlock( pNode->body ) != "endfor" )
+                    {
+                        error( "Expected {% endfor %}" );
+                    }
+                    nodes.push_back( std::move( pNode ) );
+                }
+                else if( tokens.size() == 2 && tokens[ 0 ] == "if" )
+                {
+                    auto pNode  = std::make_unique< Node >();
+                    pNode->type = Node::eIf;
+                    pNode->path = parsePath( tokens[ 1 ] );
+
+                    std::string strTerminator = parseBlock( pNode->body );
+                    if( strTerminator == "else" )
+                    {
+                        strTerminator = parseBlock( pNode->elseBody );
+                    }
+                    if( strTerminator != "endif" )
+                    {
+                        error( "Expected {% endif %}" );
+                    }
+                    nodes.push_back( std::move( pNode ) );
+                }
+                else if( tokens.size() == 1
+                         && ( tokens[ 0 ] == "endfor" || tokens[ 0 ] == "endif" || tokens[ 0 ] == "else" ) )
+                {
+                    return tokens[ 0 ];
+                }
+                else
+                {
+                    error( "Unsupported statement: " + strStatement );
+                }
+            }
+        }
+        return {};
+    }
+
+    const std::string& m_strName;
+    const std::string& m_strSource;
+    std::size_t        m_szPos = 0U;
+};
+
+std::string escapeCPP( const std::string& str )
+{
+    std::ostringstream os;
+    for( char c : str )
+    {
+        switch( c )
+        {
+            case '\n':
+                os << "\\n";
+                break;
+            case '\r':
+                os << "\\r";
+                break;
+            case '\t':
+                os << "\\t";
+                break;
+            case '\"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            case '?':
+                // avoid trigraphs
+                os << "\\?";
+                break;
+            default:
+                os << c;
+                break;
+        }
+    }
+    return os.str();
+}
+
+// write a string literal split over multiple lines to keep within compiler limits
+void writeLiteral( std::ostream& os, const std::string& str, const std::string& strIndent )
+{
+    if( str.empty() )
+    {
+        os << "\"\"";
+        return;
+    }
+    bool bFirst = true;
+    for( std::size_t szPos = 0U; szPos < str.size(); )
+    {
+        std::size_t szEnd = str.find( '\n', szPos );
+        szEnd             = ( szEnd == std::string::npos ) ? str.size() : std::min( szEnd + 1, str.size() );
+        szEnd             = std::min( szEnd, szPos + 512U );
+        if( !bFirst )
+        {
+            os << "\n" << strIndent;
+        }
+        bFirst = false;
+        os << "\"" << escapeCPP( str.substr( szPos, szEnd - szPos ) ) << "\"";
+        szPos = szEnd;
+    }
+}
+
+class Generator
+{
+public:
+    Generator( std::ostream& os )
+        : m_os( os )
+    {
+    }
+
+    void generate( const Node::Vector& nodes )
+    {
+        m_scopes.clear();
+        m_iVariable = 0;
+        generateBlock( nodes, 1 );
+    }
+
+private:
+    std::string indent( int iDepth ) const { return std::string( iDepth * 4, ' ' ); }
+
+    std::string valueExpression( const std::vector< std::string >& path ) const
+    {
+        std::string strResult;
+        std::size_t szStart = 0U;
+
+        // loop variables shadow the template data
+        for( auto i = m_scopes.rbegin(), iEnd = m_scopes.rend(); i != iEnd; ++i )
+        {
+            if( i->first == path.front() )
+            {
+                strResult = i->second;
+                szStart   = 1U;
+                break;
+            }
+        }
+        if( strResult.empty() )
+        {
+            strResult = "data";
+        }
+
+        std::string strPath;
+        for( std::size_t i = 0U; i != path.size(); ++i )
+        {
+            if( i != 0U )
+                strPath += ".";
+            strPath += path[ i ];
+            if( i >= szStart )
+            {
+                strResult = "lookup( " + strResult + ", \"" + path[ i ] + "\", \"" + strPath + "\" )";
+            }
+        }
+        return strResult;
+    }
+
+    void generateBlock( const Node::Vector& nodes, int iDepth )
+    {
+        for( const auto& pNode : nodes )
+        {
+            switch( pNode->type )
+            {
+                case Node::eText:
+                {
+                    m_os << indent( iDepth ) << "os.write( ";
+                    writeLiteral( m_os, pNode->strText, indent( iDepth + 1 ) );
+                    m_os << ", " << pNode->strText.size() << " );\n";
+                }
+                break;
+                case Node::ePrint:
+                {
+                    m_os << indent( iDepth ) << "print( os, " << valueExpression( pNode->path ) << ", pSlots );\n";
+                }
+                break;
+                case Node::eFor:
+                {
+                    const std::string strVariable = "v_" + pNode->strLoopVariable + "_" + std::to_string( m_iVariable++ );
+                    m_os << indent( iDepth ) << "for( const nlohmann::json& " << strVariable << " : iterate( "
+                         << valueExpression( pNode->path ) << " ) )\n";
+                    m_os << indent( iDepth ) << "{\n";
+                    m_scopes.emplace_back( pNode->strLoopVariable, strVariable );
+                    generateBlock( pNode->body, iDepth + 1 );
+                    m_scopes.pop_back();
+                    m_os << indent( iDepth ) << "}\n";
+                }
+                break;
+                case Node::eIf:
+                {
+                    m_os << indent( iDepth ) << "if( truthy( " << valueExpression( pNode->path ) << " ) )\n";
+                    m_os << indent( iDepth ) << "{\n";
+                    generateBlock( pNode->body, iDepth + 1 );
+                    m_os << indent( iDepth ) << "}\n";
+                    if( !pNode->elseBody.empty() )
+                    {
+                        m_os << indent( iDepth ) << "else\n";
+                        m_os << indent( iDepth ) << "{\n";
+                        generateBlock( pNode->elseBody, iDepth + 1 );
+                        m_os << indent( iDepth ) << "}\n";
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    std::ostream&                                      m_os;
+    std::vector< std::pair< std::string, std::string > > m_scopes;
+    int                                                m_iVariable = 0;
+};
+
+const char* g_pszFileHeader = R"(// Generated by report_template_compiler - DO NOT EDIT
+)";
+
+const char* g_pszRuntime = R"(
+namespace
+{
+
+inline const nlohmann::json& lookup( const nlohmann::json& data, const char* pszKey, const char* pszPath )
+{
+    if( data.is_array() )
+    {
+        const std::size_t szIndex = std::strtoul( pszKey, nullptr, 10 );
+        if( szIndex < data.size() )
+        {
+            return data[ szIndex ];
+        }
+    }
+    else
+    {
+        auto iFind = data.find( pszKey );
+        if( iFind != data.end() )
+        {
+            return *iFind;
+        }
+    }
+    throw std::runtime_error( std::string( "variable '" ) + pszPath + "' not found" );
+}
+
+inline const nlohmann::json& iterate( const nlohmann::json& data )
+{
+    if( !data.is_array() )
+    {
+        throw std::runtime_error( "object must be an array" );
+    }
+    return data;
+}
+
+inline bool truthy( const nlohmann::json& data )
+{
+    if( data.is_boolean() )
+        return data.get< bool >();
+    else if( data.is_number() )
+        return data != 0;
+    else if( data.is_null() )
+        return false;
+    return !data.empty();
+}
+
+inline void print( std::ostream& os, const nlohmann::json& value, report::TemplateSlots* pSlots )
+{
+    if( value.is_string() )
+    {
+        const auto& str = value.get_ref< const nlohmann::json::string_t& >();
+        os.write( str.data(), str.size() );
+    }
+    else if( value.is_number_unsigned() )
+    {
+        os << value.get< nlohmann::json::number_unsigned_t >();
+    }
+    else if( value.is_number_integer() )
+    {
+        os << value.get< nlohmann::json::number_integer_t >();
+    }
+    else if( pSlots && value.is_binary() )
+    {
+        pSlots->write( report::TemplateSlots::slot( value ).value(), os );
+    }
+    else if( !value.is_null() )
+    {
+        os << value.dump();
+    }
+}
+
+} // namespace
+)";
+
+} // namespace
+
+int main( int argc, const char* argv[] )
+{
+    std::string                strHeader, strSource, strNamespace = "report::templates";
+    std::vector< std::string > templates;
+
+    {
+        bool bShowHelp = false;
+
+        namespace po = boost::program_options;
+        po::options_description options;
+
+        // clang-format off
+        options.add_options()
+        ( "help",       po::bool_switch( &bShowHelp ),                                    "Show Command Line Help" )
+        ( "header",     po::value< std::string >( &strHeader ),                           "Output header file" )
+        ( "source",     po::value< std::string >( &strSource ),                           "Output source file" )
+        ( "namespace",  po::value< std::string >( &strNamespace ),                        "Namespace of generated functions" )
+        ( "templates",  po::value< std::vector< std::string > >( &templates ),            "Jinja template files" )
+        ;
+        // clang-format on
+
+        po::positional_options_description p;
+        p.add( "templates", -1 );
+
+        po::variables_map vm;
+        po::store( po::command_line_parser( argc, argv ).options( options ).positional( p ).run(), vm );
+        po::notify( vm );
+
+        if( bShowHelp )
+        {
+            std::cout << options << "\n";
+            return 0;
+        }
+    }
+
+    try
+    {
+        if( strHeader.empty() || strSource.empty() )
+        {
+            throw std::runtime_error( "Missing header or source output file" );
+        }
+
+        std::ostringstream osHeader, osSource;
+
+        const std::string strGuard = "GUARD_REPORT_COMPILED_TEMPLATES_"
+                                     + boost::to_upper_copy( boost::filesystem::path( strHeader ).stem().string() );
+
+        osHeader << g_pszFileHeader << "\n"
+                 << "#ifndef " << strGuard << "\n"
+                 << "#define " << strGuard << "\n\n"
+                 << "#include \"report/template_slots.hpp\"\n\n"
+                 << "#include <nlohmann/json.hpp>\n\n"
+                 << "#include <ostream>\n"
+                 << "#include <string_view>\n\n"
+                 << "namespace " << strNamespace << "\n{\n";
+
+        osSource << g_pszFileHeader << "\n"
+                 << "#include \"" << boost::filesystem::path( strHeader ).filename().string() << "\"\n\n"
+                 << "#include <cstdlib>\n"
+                 << "#include <stdexcept>\n"
+                 << "#include <string>\n\n"
+                 << "namespace " << strNamespace << "\n{\n"
+                 << g_pszRuntime;
+
+        for( const auto& strTemplate : templates )
+        {
+            const boost::filesystem::path templatePath( strTemplate );
+            const std::string             strName = templatePath.stem().string();
+
+            std::string strContents;
+            {
+                std::ifstream file( templatePath.string(), std::ios::binary );
+                if( !file.good() )
+                {
+                    throw std::runtime_error( "Failed to open template: " + strTemplate );
+                }
+                std::ostringstream osFile;
+                osFile << file.rdbuf();
+                strContents = osFile.str();
+            }
+
+            Parser             parser( strTemplate, strContents );
+            const Node::Vector nodes = parser.parse();
+
+            osHeader << "\n// " << templatePath.filename().string() << "\n"
+                     << "extern const std::string_view " << strName << "_source;\n"
+                     << "void render_" << strName
+                     << "( const nlohmann::json& data, std::ostream& os, report::TemplateSlots* pSlots );\n";
+
+            osSource << "\n// " << templatePath.filename().string() << "\n"
+                     << "const std::string_view " << strName << "_source = std::string_view( ";
+            writeLiteral( osSource, strContents, "    " );
+            osSource << ", " << strContents.size() << " );\n\n";
+
+            osSource << "void render_" << strName
+                     << "( const nlohmann::json& data, std::ostream& os, report::TemplateSlots* pSlots )\n{\n";
+            // NOTE: templates such as the style sheet use neither the data nor any slots
+            osSource << "    ( void )data;\n"
+                     << "    ( void )pSlots;\n";
+            Generator generator( osSource );
+            generator.generate( nodes );
+            osSource << "}\n";
+        }
+
+        osHeader << "\n} // namespace " << strNamespace << "\n\n#endif // " << strGuard << "\n";
+        osSource << "\n} // namespace " << strNamespace << "\n";
+
+        for( const auto& [ strFile, pContents ] :
+             { std::make_pair( strHeader, &osHeader ), std::make_pair( strSource, &osSource ) } )
+        {
+            boost::filesystem::create_directories( boost::filesystem::path( strFile ).parent_path() );
+            std::ofstream file( strFile, std::ios::binary | std::ios::trunc );
+            file << pContents->str();
+            if( !file.good() )
+            {
+                throw std::runtime_error( "Failed to write: " + strFile );
+            }
+        }
+    }
+    catch( std::exception& ex )
+    {
+        std::cerr << "Exception: " << ex.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/report.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace
+{
+
+using BenchmarkValue = std::variant< int, double, std::string >;
+
+// the previous Line which held its url and bookmark inline
+template < typename Value >
+struct LegacyLine
+{
+    Value                        m_element;
+    std::optional< report::URL > m_url;
+    std::optional< Value >       m_bookmark;
+    report::Colour               m_colour            = report::Colour::black;
+    report::Colour               m_background_colour = report::Colour::white;
+};
+
+template < typename Value >
+using LegacyContainer = std::variant< LegacyLine< Value >, report::Multiline< Value >, report::Branch< Value >,
+                                      report::Table< Value >, report::Plot< Value >, report::Graph< Value > >;
+
+// counts the bytes requested by the table so the row vectors are included
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t szBytes = 0U;
+
+private:
+    void* do_allocate( std::size_t szSize, std::size_t szAlign ) override
+    {
+        szBytes += szSize;
+        return std::pmr::new_delete_resource()->allocate( szSize, szAlign );
+    }
+    void do_deallocate( void* p, std::size_t szSize, std::size_t szAlign ) override
+    {
+        std::pmr::new_delete_resource()->deallocate( p, szSize, szAlign );
+    }
+    bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override { return this == &other; }
+};
+
+// a table of three Line cells per row
+template < typename Cell, typename Line >
+void buildTable( benchmark::State& state )
+{
+    const std::size_t szRows = static_cast< std::size_t >( state.range( 0 ) );
+    CountingResource  counting;
+    for( auto _ : state )
+    {
+        counting.szBytes = 0U;
+        std::pmr::vector< std::pmr::vector< Cell > > rows( &counting );
+        rows.reserve( szRows );
+        for( std::size_t i = 0U; i != szRows; ++i )
+        {
+            auto& row = rows.emplace_back();
+            row.reserve( 3U );
+            row.push_back( Line{ BenchmarkValue{ static_cast< int >( i ) } } );
+            row.push_back( Line{ BenchmarkValue{ i * 0.5 } } );
+            row.push_back( Line{ BenchmarkValue{ std::string( "BM_Name" ) } } );
+        }
+        benchmark::DoNotOptimize( rows.data() );
+    }
+    state.counters[ "bytes_per_cell" ] = static_cast< double >( counting.szBytes ) / static_cast< double >( szRows * 3U );
+    state.SetItemsProcessed( static_cast< int64_t >( state.iterations() * szRows * 3U ) );
+}
+
+void BM_TableCells_Legacy( benchmark::State& state )
+{
+    buildTable< LegacyContainer< BenchmarkValue >, LegacyLine< BenchmarkValue > >( state );
+}
+
+void BM_TableCells( benchmark::State& state )
+{
+    buildTable< report::Container< BenchmarkValue >, report::Line< BenchmarkValue > >( state );
+}
+
+} // namespace
+
+BENCHMARK( BM_TableCells_Legacy )->Arg( 100000 )->Unit( benchmark::kMillisecond );
+BENCHMARK( BM_TableCells )->Arg( 100000 )->Unit( benchmark::kMillisecond );
@@ -0,0 +1,109 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/html_escape.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// the previous five pass implementation
+std::string legacyEscapeHTML( std::string data )
+{
+    using boost::algorithm::replace_all;
+    replace_all( data, "&", "&amp;" );
+    replace_all( data, "\"", "&quot;" );
+    replace_all( data, "\'", "&apos;" );
+    replace_all( data, "<", "&lt;" );
+    replace_all( data, ">", "&gt;" );
+    return data;
+}
+
+// text heavy report cells with one special character per iSpecialEvery characters
+std::vector< std::string > makeCells( int iSpecialEvery )
+{
+    static const std::string strSpecial = "&\"'<>";
+    static const std::string strPlain   = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789.";
+
+    std::mt19937                    random( 1234 );
+    std::uniform_int_distribution<> length( 4, 120 );
+
+    std::vector< std::string > cells( 10000 );
+    int                        iCount = 0;
+    for( auto& str : cells )
+    {
+        str.resize( length( random ) );
+        for( char& c : str )
+        {
+            c = ( iSpecialEvery && ( ++iCount % iSpecialEvery == 0 ) ) ? strSpecial[ random() % strSpecial.size() ]
+                                                                       : strPlain[ random() % strPlain.size() ];
+        }
+    }
+    return cells;
+}
+
+void setBytes( benchmark::State& state, const std::vector< std::string >& cells )
+{
+    std::size_t szTotal = 0U;
+    for( const auto& str : cells )
+        szTotal += str.size();
+    state.SetBytesProcessed( static_cast< int64_t >( state.iterations() * szTotal ) );
+}
+
+void BM_EscapeHTML_Legacy( benchmark::State& state )
+{
+    const auto cells = makeCells( static_cast< int >( state.range( 0 ) ) );
+    for( auto _ : state )
+    {
+        for( const auto& str : cells )
+        {
+            benchmark::DoNotOptimize( legacyEscapeHTML( str ) );
+        }
+    }
+    setBytes( state, cells );
+}
+
+void BM_EscapeHTML( benchmark::State& state )
+{
+    const auto  cells = makeCells( static_cast< int >( state.range( 0 ) ) );
+    std::string strBuffer;
+    for( auto _ : state )
+    {
+        for( const auto& str : cells )
+        {
+            strBuffer.clear();
+            report::escapeHTML( str, strBuffer );
+            benchmark::DoNotOptimize( strBuffer.data() );
+        }
+    }
+    setBytes( state, cells );
+}
+
+} // namespace
+
+// argument is the frequency of special characters - zero for none
+BENCHMARK( BM_EscapeHTML_Legacy )->Arg( 0 )->Arg( 100 )->Arg( 10 );
+BENCHMARK( BM_EscapeHTML )->Arg( 0 )->Arg( 100 )->Arg( 10 );
@@ -0,0 +1,93 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/report.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <memory_resource>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+using HeapValue  = std::variant< int, double, std::string >;
+using ArenaValue = std::variant< int, double, std::pmr::string >;
+
+} // namespace
+
+template <>
+struct report::ContainerTraits< ArenaValue > : report::PMRContainerTraits
+{
+};
+
+namespace
+{
+
+// a nightly style report of many small tables of counts, timings and names
+template < typename V, typename String >
+report::Container< V > makeReport()
+{
+    using namespace report;
+    using B = Branch< V >;
+    using L = Line< V >;
+    using T = Table< V >;
+
+    B root{ { String( "Nightly" ) } };
+    for( int i = 0; i != 1000; ++i )
+    {
+        T table{ { String( "Count" ), String( "Time" ), String( "Name of the benchmark" ) } };
+        for( int j = 0; j != 100; ++j )
+        {
+            table.m_rows.push_back( { L{ j }, L{ i * 0.25 + j }, L{ String( "BM_Example/with/a/long/name" ) } } );
+        }
+        root.m_elements.push_back( std::move( table ) );
+    }
+    return root;
+}
+
+void BM_ReportTree_Heap( benchmark::State& state )
+{
+    for( auto _ : state )
+    {
+        auto report = makeReport< HeapValue, std::string >();
+        benchmark::DoNotOptimize( &report );
+    }
+}
+
+void BM_ReportTree_Arena( benchmark::State& state )
+{
+    for( auto _ : state )
+    {
+        std::pmr::monotonic_buffer_resource arena( 1U << 20U );
+        std::pmr::memory_resource*          pPrevious = std::pmr::set_default_resource( &arena );
+        {
+            auto report = makeReport< ArenaValue, std::pmr::string >();
+            benchmark::DoNotOptimize( &report );
+        }
+        std::pmr::set_default_resource( pPrevious );
+    }
+}
+
+} // namespace
+
+BENCHMARK( BM_ReportTree_Heap )->Unit( benchmark::kMillisecond );
+BENCHMARK( BM_ReportTree_Arena )->Unit( benchmark::kMillisecond );
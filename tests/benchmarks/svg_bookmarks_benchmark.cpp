@@ -0,0 +1,121 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/svg_bookmarks.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <boost/algorithm/string.hpp>
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+
+// the previous in place implementation
+void legacyFixGraphvizBookmarks( std::string& str )
+{
+    static const std::string strSearch  = "<g id=\"a_";
+    static const std::string strReplace = "<text ";
+
+    using Iter = std::string::iterator;
+
+    for( Iter i = str.begin(), iEnd = str.end(); i != iEnd;
+         i = std::search( i, iEnd, strSearch.begin(), strSearch.end() ) )
+    {
+        Iter r = std::search( i, iEnd, strReplace.begin(), strReplace.end() );
+        if( r != iEnd )
+        {
+            Iter idStart    = i + 2;
+            int  quoteCount = 0;
+
+            Iter idEnd = idStart;
+            for( ; ( idEnd != iEnd ) && ( quoteCount != 2 ); )
+            {
+                if( *idEnd == '\"' )
+                {
+                    ++quoteCount;
+                }
+                ++idEnd;
+            }
+
+            Iter newID = r + 6;
+
+            std::string strTemp( idStart, idEnd );
+            boost::replace_all( strTemp, "\"a_", "  \"" );
+
+            auto iNewIDStart = std::copy( idEnd, newID, idStart );
+            std::copy( strTemp.begin(), strTemp.end(), iNewIDStart );
+        }
+    }
+}
+
+// graphviz style svg of iNodes table nodes each with a bookmarked first cell and a plain second cell
+std::string makeGraphvizSVG( int iNodes )
+{
+    std::string strSVG = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+                         "<svg width=\"800pt\" height=\"600pt\" viewBox=\"0.00 0.00 800.00 600.00\">\n"
+                         "<g id=\"graph0\" class=\"graph\" transform=\"scale(1 1) rotate(0) translate(4 596)\">\n";
+    for( int i = 0; i != iNodes; ++i )
+    {
+        const std::string strIndex = std::to_string( i );
+        strSVG += "<g id=\"node" + strIndex + "\" class=\"node\">\n<title>Node" + strIndex + "</title>\n";
+        strSVG += "<g id=\"a_node" + strIndex + "_0\"><a xlink:href=\"#bookmark" + strIndex
+                  + "\" xlink:title=\"&lt;TABLE&gt;\">\n";
+        strSVG += "<polygon fill=\"none\" stroke=\"black\" points=\"8,-4 8,-20 64,-20 64,-4 8,-4\"/>\n";
+        strSVG += "<text text-anchor=\"start\" x=\"11\" y=\"-9.8\" font-family=\"monospace\" font-size=\"10.00\">Node "
+                  + strIndex + "</text>\n</a>\n</g>\n";
+        strSVG += "<polygon fill=\"none\" stroke=\"black\" points=\"64,-4 64,-20 120,-20 120,-4 64,-4\"/>\n";
+        strSVG += "<text text-anchor=\"start\" x=\"67\" y=\"-9.8\" font-family=\"monospace\" font-size=\"10.00\">"
+                  "value</text>\n</g>\n";
+    }
+    strSVG += "</g>\n</svg>\n";
+    return strSVG;
+}
+
+void BM_SVGBookmarks_Legacy( benchmark::State& state )
+{
+    const std::string strSVG = makeGraphvizSVG( static_cast< int >( state.range( 0 ) ) );
+    for( auto _ : state )
+    {
+        std::string str = strSVG;
+        legacyFixGraphvizBookmarks( str );
+        benchmark::DoNotOptimize( str.data() );
+    }
+    state.SetBytesProcessed( static_cast< int64_t >( state.iterations() * strSVG.size() ) );
+}
+
+void BM_SVGBookmarks( benchmark::State& state )
+{
+    const std::string strSVG = makeGraphvizSVG( static_cast< int >( state.range( 0 ) ) );
+    std::string       str;
+    for( auto _ : state )
+    {
+        str.clear();
+        report::rewriteSVGBookmarks( strSVG, str );
+        benchmark::DoNotOptimize( str.data() );
+    }
+    state.SetBytesProcessed( static_cast< int64_t >( state.iterations() * strSVG.size() ) );
+}
+
+} // namespace
+
+BENCHMARK( BM_SVGBookmarks_Legacy )->Arg( 50 )->Arg( 500 )->Arg( 5000 );
+BENCHMARK( BM_SVGBookmarks )->Arg( 50 )->Arg( 500 )->Arg( 5000 );
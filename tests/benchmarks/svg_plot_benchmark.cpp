@@ -0,0 +1,65 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/svg_plot.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+namespace
+{
+
+// a bench_summary style plot of iPoints timings with dates as hover labels
+nlohmann::json makePlot( int iPoints, const char* pszStyle )
+{
+    nlohmann::json data( { { "headings", { "BM Example Benchmark" } },
+                           { "points", nlohmann::json::array() },
+                           { "style", { { "bars", false }, { "lines", false }, { "scatter", false } } } } );
+    data[ "style" ][ pszStyle ] = true;
+
+    std::mt19937                       random( 1234 );
+    std::uniform_real_distribution<> time( 20000.0, 30000.0 );
+    for( int i = 0; i != iPoints; ++i )
+    {
+        data[ "points" ].push_back(
+            { { "values", { std::to_string( i ), std::to_string( time( random ) ), "2024-03-13T02:01:32+00:00" } } } );
+    }
+    return data;
+}
+
+void BM_NativePlot( benchmark::State& state, const char* pszStyle )
+{
+    const nlohmann::json data = makePlot( static_cast< int >( state.range( 0 ) ), pszStyle );
+    std::string          strSVG;
+    for( auto _ : state )
+    {
+        strSVG.clear();
+        report::renderSVGPlot( data, strSVG );
+        benchmark::DoNotOptimize( strSVG.data() );
+    }
+    state.SetItemsProcessed( state.iterations() );
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE( BM_NativePlot, bars, "bars" )->Arg( 10 )->Arg( 100 )->Arg( 1000 );
+BENCHMARK_CAPTURE( BM_NativePlot, lines, "lines" )->Arg( 10 )->Arg( 100 )->Arg( 1000 );
+BENCHMARK_CAPTURE( BM_NativePlot, scatter, "scatter" )->Arg( 10 )->Arg( 100 )->Arg( 1000 );
@@ -0,0 +1,135 @@
+//  Copyright (c) Deighton Systems Limited. 2022. All Rights Reserved.
+//  Author: Edward Deighton
+//  License: Please see license.txt in the project root folder.
+
+//  Use and copying of this software and preparation of derivative works
+//  based upon this software are permitted. Any copy of this software or
+//  of any derivative work must include the above copyright notice, this
+//  paragraph and the one after it.  Any distribution of this software or
+//  derivative works must comply with all applicable laws.
+
+//  This software is made available AS IS, and COPYRIGHT OWNERS DISCLAIMS
+//  ALL WARRANTIES, EXPRESS OR IMPLIED, INCLUDING WITHOUT LIMITATION THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE, AND NOTWITHSTANDING ANY OTHER PROVISION CONTAINED HEREIN, ANY
+//  LIABILITY FOR DAMAGES RESULTING FROM THE SOFTWARE OR ITS USE IS
+//  EXPRESSLY DISCLAIMED, WHETHER ARISING IN CONTRACT, TORT (INCLUDING
+//  NEGLIGENCE) OR STRICT LIABILITY, EVEN IF COPYRIGHT OWNERS ARE ADVISED
+//  OF THE POSSIBILITY OF SUCH DAMAGES.
+
+#include "report/renderer_html.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace
+{
+
+using BenchmarkValue = std::variant< int, double, std::string >;
+
+// a million table cells of benchmark style counts, timings and names
+std::vector< BenchmarkValue > makeValues()
+{
+    std::mt19937                     random( 1234 );
+    std::uniform_int_distribution<>  count( 0, 1000000 );
+    std::uniform_real_distribution<> time( 20000.0, 30000.0 );
+
+    std::vector< BenchmarkValue > values;
+    values.reserve( 1000000 );
+    for( int i = 0; i != 1000000; ++i )
+    {
+        switch( i % 3 )
+        {
+            case 0:
+                values.emplace_back( count( random ) );
+                break;
+            case 1:
+                values.emplace_back( time( random ) );
+                break;
+            default:
+                values.emplace_back( "BM_Example/" + std::to_string( i ) );
+                break;
+        }
+    }
+    return values;
+}
+
+// the previous stream based implementation
+std::string legacyToString( const BenchmarkValue& value )
+{
+    std::ostringstream osValue;
+    std::visit( [ & ]( const auto& arg ) { osValue << arg; }, value );
+    return osValue.str();
+}
+
+void BM_FormatValue_Legacy( benchmark::State& state )
+{
+    const auto  values = makeValues();
+    std::string strOutput;
+    for( auto _ : state )
+    {
+        strOutput.clear();
+        for( const auto& value : values )
+        {
+            report::escapeHTML( legacyToString( value ), strOutput );
+        }
+        benchmark::DoNotOptimize( strOutput.data() );
+    }
+    state.SetItemsProcessed( static_cast< int64_t >( state.iterations() * values.size() ) );
+}
+
+void BM_FormatValue( benchmark::State& state )
+{
+    const auto  values = makeValues();
+    std::string strOutput, strBuffer;
+    for( auto _ : state )
+    {
+        strOutput.clear();
+        for( const auto& value : values )
+        {
+            report::escapeHTML( report::formatValue( value, strBuffer ), strOutput );
+        }
+        benchmark::DoNotOptimize( strOutput.data() );
+    }
+    state.SetItemsProcessed( static_cast< int64_t >( state.iterations() * values.size() ) );
+}
+
+// discards the rendered html
+class NullSink : public report::OutputSink
+{
+public:
+    void write( const Buffer*, std::size_t ) override {}
+};
+
+void BM_RenderTable( benchmark::State& state )
+{
+    using namespace report;
+    using L = Line< BenchmarkValue >;
+    using T = Table< BenchmarkValue >;
+
+    const auto values = makeValues();
+    T          table{ { "Count", "Time", "Name" } };
+    for( std::size_t i = 0U; i + 3U <= values.size(); i += 3U )
+    {
+        table.m_rows.push_back( { L{ values[ i ] }, L{ values[ i + 1U ] }, L{ values[ i + 2U ] } } );
+    }
+    const Container< BenchmarkValue > report = table;
+
+    for( auto _ : state )
+    {
+        NullSink sink;
+        renderHTML( report, sink );
+    }
+    state.SetItemsProcessed( static_cast< int64_t >( state.iterations() * values.size() ) );
+}
+
+} // namespace
+
+BENCHMARK( BM_FormatValue_Legacy )->Unit( benchmark::kMillisecond );
+BENCHMARK( BM_FormatValue )->Unit( benchmark::kMillisecond );
+BENCHMARK( BM_RenderTable )->Unit( benchmark::kMillisecond );
@@ -20,11 +20,32 @@
 #include <gtest/gtest.h>
 
 #include "report/report.hpp"
+#include "report/binary_report.hpp"
 #include "report/renderer_html.hpp"
+#include "report/external_process.hpp"
+#include "report/gnuplot.hpp"
+#include "report/hash.hpp"
+#include "report/interned_string.hpp"
+#include "report/output_sink.hpp"
+#include "report/svg_bookmarks.hpp"
+#include "report/svg_plot.hpp"
 
 #include "common/file.hpp"
 
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/string.hpp>
+
+#include <fstream>
+#include <map>
+#include <memory_resource>
 #include <sstream>
+#include <thread>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 extern boost::filesystem::path g_resultDir;
 extern boost::filesystem::path g_templateDir;
@@ -48,6 +69,16 @@ std::ostream& operator<<( std::ostream& os, Foobar v )
     }
 }
 
+// formats Foobar values without a stream
+template <>
+struct report::ValueFormatter< Foobar >
+{
+    static std::string_view format( Foobar value, std::string& )
+    {
+        return value == eOne ? "One" : "Two";
+    }
+};
+
 TEST( Report, Basic )
 {
     using namespace std::string_literals;
@@ -169,3 +200,1670 @@ TEST( Report, Basic )
     auto pFile = boost::filesystem::createNewFileStream( g_resultDir / "basic.html" );
     *pFile << os.str();
 }
+
+namespace
+{
+using TestValue = std::variant< int, double, std::string, Foobar >;
+
+report::Container< TestValue > makeTextReport()
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B    = Branch< V >;
+    using L    = Line< V >;
+    using M    = Multiline< V >;
+    using T    = Table< V >;
+
+    // clang-format off
+    return
+    B
+    { 
+        { "Report.Text"s }, 
+        { 
+            L{ "<T1>"s, std::nullopt, "bookmark"s }, 
+            B
+            { 
+                { "Nested"s, eTwo }, 
+                { 
+                    M{ {  "T2a"s, " "s, eOne }, std::nullopt, std::nullopt, Colour::red }
+                } 
+            }, 
+            T{ { "H1"s, "H2"s },
+            {
+                { L{ 1 }, L{ 2.5 } },
+                { L{ eOne }, M{ { "a & b"s, 3 } } }
+            }},
+            T{ {},
+            {
+                { L{ "no headings"s } }
+            }}
+        } 
+    };
+    // clang-format on
+}
+} // namespace
+
+TEST( Report, CompiledTemplates )
+{
+    using namespace report;
+
+    const auto c = makeTextReport();
+
+    std::ostringstream osCompiled;
+    {
+        HTMLTemplateEngine templateEngine{ true, true };
+        renderHTML( c, osCompiled, templateEngine );
+    }
+
+    // the second engine reuses the templates parsed for the first
+    for( int i = 0; i != 2; ++i )
+    {
+        std::ostringstream osInterpreted;
+        HTMLTemplateEngine templateEngine{ true, false };
+        renderHTML( c, osInterpreted, templateEngine );
+        ASSERT_EQ( osCompiled.str(), osInterpreted.str() );
+    }
+}
+
+TEST( Report, DefaultEngine )
+{
+    using namespace report;
+
+    const auto c = makeTextReport();
+
+    std::ostringstream osEngine, osDefault;
+    {
+        HTMLTemplateEngine templateEngine{ false };
+        renderHTML( c, osEngine, templateEngine );
+    }
+    renderHTML( c, osDefault );
+    ASSERT_EQ( osEngine.str(), osDefault.str() );
+    ASSERT_EQ( &HTMLTemplateEngine::getDefault(), &HTMLTemplateEngine::getDefault() );
+}
+
+TEST( Report, Streaming )
+{
+    using namespace report;
+
+    const auto c = makeTextReport();
+
+    std::ostringstream osStreamed, osCopied;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osStreamed, templateEngine );
+    }
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setStreaming( false );
+        renderHTML( c, osCopied, templateEngine );
+    }
+    ASSERT_EQ( osStreamed.str(), osCopied.str() );
+}
+
+TEST( Report, EscapeHTML )
+{
+    const auto reference = []( const std::string& str )
+    {
+        std::string strResult;
+        for( char c : str )
+        {
+            switch( c )
+            {
+                case '&':
+                    strResult += "&amp;";
+                    break;
+                case '\"':
+                    strResult += "&quot;";
+                    break;
+                case '\'':
+                    strResult += "&apos;";
+                    break;
+                case '<':
+                    strResult += "&lt;";
+                    break;
+                case '>':
+                    strResult += "&gt;";
+                    break;
+                case '\x1e':
+                    strResult += "&#30;";
+                    break;
+                default:
+                    strResult += c;
+                    break;
+            }
+        }
+        return strResult;
+    };
+
+    // place special characters either side of the simd block boundaries
+    const std::string strSpecial = "&\"'<>\x1e";
+    for( std::size_t szLength = 0U; szLength != 80U; ++szLength )
+    {
+        for( std::size_t szPos = 0U; szPos < szLength; szPos += 7U )
+        {
+            std::string str( szLength, 'x' );
+            str[ szPos ]               = strSpecial[ szPos % strSpecial.size() ];
+            str[ szLength - 1U ]       = strSpecial[ szLength % strSpecial.size() ];
+            const std::string strPrior = "prefix";
+            std::string       strOutput( strPrior );
+            report::escapeHTML( str, strOutput );
+            ASSERT_EQ( strOutput, strPrior + reference( str ) );
+        }
+    }
+    ASSERT_EQ( report::escapeHTML( "<a href=\"x\">'&'</a>" ), "&lt;a href=&quot;x&quot;&gt;&apos;&amp;&apos;&lt;/a&gt;" );
+
+    // user text cannot forge the template slot markers of the inja renderer
+    ASSERT_EQ( report::escapeHTML( "\x1e" "0\x1e" ), "&#30;0&#30;" );
+}
+
+TEST( Report, Parallel )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using L = Line< V >;
+    using T = Table< V >;
+
+    B root{ { "Report.Parallel"s } };
+    for( int i = 0; i != 50; ++i )
+    {
+        B branch{ { "Branch"s, i } };
+        for( int j = 0; j != 20; ++j )
+        {
+            T table{ { "Index"s, "Value"s } };
+            for( int k = 0; k != 10; ++k )
+            {
+                table.m_rows.push_back( { L{ k }, L{ "<value & "s + std::to_string( i * j * k ) + ">"s } } );
+            }
+            branch.m_elements.push_back( makeTextReport() );
+            branch.m_elements.push_back( std::move( table ) );
+        }
+        root.m_elements.push_back( std::move( branch ) );
+    }
+    const Container< V > c = root;
+
+    std::ostringstream osSerial;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osSerial, templateEngine );
+    }
+
+    ThreadPool pool( 4 );
+    for( std::size_t szGrainSize : { 1U, 16U, 1000U } )
+    {
+        std::ostringstream osParallel;
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setThreadPool( &pool, szGrainSize );
+        renderHTML( c, osParallel, templateEngine );
+        ASSERT_EQ( osSerial.str(), osParallel.str() );
+    }
+}
+
+namespace
+{
+report::Container< TestValue > makeProcessReport()
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using L = Line< V >;
+    using P = Plot< V >;
+    using G = Graph< V >;
+
+    B root{ { "Report.Processes"s } };
+    for( int i = 0; i != 8; ++i )
+    {
+        P plot{ { "Plot"s, i } };
+        for( int j = 0; j != 4; ++j )
+        {
+            plot.m_points.push_back( { j, i * j, "point"s + std::to_string( j ) } );
+        }
+
+        G graph;
+        for( int j = 0; j <= i; ++j )
+        {
+            graph.m_nodes.push_back( G::Node{ { { "Node"s, j } } } );
+        }
+        graph.m_edges.push_back( G::Edge{ 0, static_cast< std::size_t >( i ) } );
+
+        root.m_elements.push_back( L{ "Before "s + std::to_string( i ) } );
+        root.m_elements.push_back( std::move( plot ) );
+        root.m_elements.push_back( B{ { "Graph"s, i }, { std::move( graph ), L{ "After "s + std::to_string( i ) } } } );
+    }
+    return root;
+}
+} // namespace
+
+TEST( Report, AsyncProcesses )
+{
+    using namespace report;
+
+    const auto c = makeProcessReport();
+
+    std::ostringstream osSerial;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osSerial, templateEngine );
+    }
+
+    ThreadPool pool( 4 );
+    for( bool bParallel : { false, true } )
+    {
+        std::ostringstream osAsync;
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setMaxProcesses( 3U );
+        if( bParallel )
+        {
+            templateEngine.setThreadPool( &pool, 1U );
+        }
+        renderHTML( c, osAsync, templateEngine );
+        ASSERT_EQ( osSerial.str(), osAsync.str() );
+    }
+}
+
+TEST( Report, DeferredOutput )
+{
+    using namespace report;
+
+    const std::string strText( DeferredOutput::DRAIN_SIZE, 'x' );
+
+    // text behind a resolved future is written through once enough is held back without another defer
+    {
+        std::ostringstream          osDestination;
+        DeferredOutput              output( osDestination );
+        std::ostream                os( &output );
+        std::promise< std::string > svg;
+        os << "head";
+        output.defer( svg.get_future().share() );
+        os << "held";
+        ASSERT_EQ( osDestination.str(), "head" );
+        svg.set_value( "<svg/>" );
+        os << strText;
+        ASSERT_EQ( osDestination.str(), "head<svg/>held" + strText );
+        output.flush();
+    }
+
+    // a future that failed meanwhile is still reported by flush
+    {
+        std::ostringstream          osDestination;
+        DeferredOutput              output( osDestination );
+        std::ostream                os( &output );
+        std::promise< std::string > svg;
+        output.defer( svg.get_future().share() );
+        svg.set_exception( std::make_exception_ptr( std::runtime_error( "failed" ) ) );
+        os << strText;
+        ASSERT_TRUE( os.good() );
+        ASSERT_THROW( output.flush(), std::runtime_error );
+    }
+}
+
+TEST( Report, GraphBatch )
+{
+    using namespace report;
+
+    const auto c = makeProcessReport();
+
+    std::ostringstream osSerial;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osSerial, templateEngine );
+    }
+
+    for( std::size_t szMaxProcesses : { 0U, 2U } )
+    {
+        std::ostringstream osBatched;
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setMaxProcesses( szMaxProcesses );
+        templateEngine.setBatchGraphs( true );
+        renderHTML( c, osBatched, templateEngine );
+        ASSERT_EQ( osSerial.str(), osBatched.str() );
+    }
+}
+
+TEST( Report, GNUPlotCoProcess )
+{
+    using namespace report;
+
+    const auto c = makeProcessReport();
+
+    std::ostringstream osProcesses;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osProcesses, templateEngine );
+    }
+
+    for( std::size_t szMaxProcesses : { 0U, 2U } )
+    {
+        std::ostringstream osCoProcess;
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setMaxProcesses( szMaxProcesses );
+        templateEngine.setPlotBackend( HTMLTemplateEngine::eGNUPlotCoProcess );
+        renderHTML( c, osCoProcess, templateEngine );
+        ASSERT_EQ( osProcesses.str(), osCoProcess.str() );
+    }
+
+    // a script that reports a warning leaves none of its output for the next script
+    GNUPlot           gnuplot;
+    const std::string strPlot     = "$data << EOD\n1 2\n2 3\nEOD\nset terminal svg\nplot $data with lines\n";
+    const std::string strExpected = gnuplot.run( strPlot, std::chrono::seconds( 10 ) );
+    ASSERT_THROW( gnuplot.run( "set print\nprint \"warning\"\n" + strPlot, std::chrono::seconds( 10 ) ),
+                  std::runtime_error );
+    ASSERT_EQ( gnuplot.run( strPlot, std::chrono::seconds( 10 ) ), strExpected );
+}
+
+TEST( Report, NativePlot )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using P = Plot< V >;
+
+    for( P::Style style : { P::Style::bars, P::Style::lines, P::Style::scatter } )
+    {
+        P plot{ { "Native"s, eOne }, {}, style };
+        for( int i = 0; i != 10; ++i )
+        {
+            plot.m_points.push_back( { i, 1.5 * i, "<point "s + std::to_string( i ) + ">"s } );
+        }
+        plot.m_points.push_back( { 10, "not a number"s } );
+        const Container< V > c = plot;
+
+        std::ostringstream os;
+        {
+            HTMLTemplateEngine templateEngine{ true };
+            templateEngine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+            renderHTML( c, os, templateEngine );
+        }
+        const std::string str = os.str();
+
+        const auto count = [ &str ]( const std::string& strSearch )
+        {
+            std::size_t szCount = 0U;
+            for( auto szPos = str.find( strSearch ); szPos != std::string::npos;
+                 szPos      = str.find( strSearch, szPos + 1U ) )
+            {
+                ++szCount;
+            }
+            return szCount;
+        };
+        ASSERT_EQ( count( "<svg" ), 1U );
+        ASSERT_EQ( count( ">Native One</text>" ), 1U );
+        ASSERT_EQ( count( "<title>&lt;point 3&gt;</title>" ), 1U );
+        ASSERT_EQ( count( "<rect x=" ), ( style.str() == "bars"s ) ? 11U : 1U );
+        ASSERT_EQ( count( "<circle " ), ( style.str() == "bars"s ) ? 0U : 10U );
+        ASSERT_EQ( count( "<polyline " ), ( style.str() == "lines"s ) ? 1U : 0U );
+
+        // non numeric and non finite x values are plotted at the point index
+        const auto render = [ &style ]( const std::vector< std::string >& xValues )
+        {
+            nlohmann::json data{ { "headings", { "Native" } },
+                                 { "style",
+                                   { { "bars", style.str() == "bars"s },
+                                     { "lines", style.str() == "lines"s },
+                                     { "scatter", style.str() == "scatter"s } } } };
+            for( std::size_t i = 0U; i != xValues.size(); ++i )
+            {
+                data[ "points" ].push_back( { { "values", { xValues[ i ], std::to_string( i * 2U ) } } } );
+            }
+            std::string strSVG;
+            renderSVGPlot( data, strSVG );
+            return strSVG;
+        };
+        const std::string strIndexed = render( { "0", "1", "2", "3", "4" } );
+        ASSERT_EQ( render( { "0", "one", "2", "", "4" } ), strIndexed );
+        ASSERT_EQ( render( { "inf", "1", "nan", "3", "-inf" } ), strIndexed );
+        ASSERT_EQ( strIndexed.find( "nan" ), std::string::npos );
+    }
+
+    // values closer together than the precision of their magnitude still give a bounded number of ticks
+    {
+        nlohmann::json data{ { "headings", { "Large" } },
+                             { "style", { { "bars", false }, { "lines", true }, { "scatter", false } } } };
+        data[ "points" ].push_back( { { "values", { "0", "100000000000000000" } } } );
+        data[ "points" ].push_back( { { "values", { "1", "100000000000000016" } } } );
+        std::string strSVG;
+        renderSVGPlot( data, strSVG );
+        ASSERT_LT( strSVG.size(), 16U * 1024U );
+        ASSERT_EQ( strSVG.find( "nan" ), std::string::npos );
+    }
+}
+
+namespace
+{
+// the fields of a Plot before it had a style
+struct PlotVersion0
+{
+    std::vector< std::string >                m_heading;
+    std::vector< std::vector< std::string > > m_points;
+
+    template < class Archive >
+    inline void serialize( Archive& archive, const unsigned int )
+    {
+        archive& m_heading;
+        archive& m_points;
+    }
+};
+} // namespace
+
+TEST( Report, PlotArchive )
+{
+    using namespace report;
+    using P = Plot< std::string >;
+
+    std::stringstream ssVersion0;
+    {
+        const PlotVersion0            plot{ { "Heading" }, { { "1", "2" }, { "3", "4" } } };
+        boost::archive::text_oarchive archive( ssVersion0 );
+        archive << plot;
+    }
+    P loaded{ {}, {}, P::Style::scatter };
+    {
+        boost::archive::text_iarchive archive( ssVersion0 );
+        archive >> loaded;
+    }
+    ASSERT_EQ( loaded.m_heading, std::vector< std::string >{ "Heading" } );
+    ASSERT_EQ( loaded.m_points.size(), 2U );
+    ASSERT_STREQ( loaded.m_style.str(), "bars" );
+
+    std::stringstream ss;
+    {
+        const P                       plot{ { "Heading" }, { { "1", "2" } }, P::Style::lines };
+        boost::archive::text_oarchive archive( ss );
+        archive << plot;
+    }
+    {
+        boost::archive::text_iarchive archive( ss );
+        archive >> loaded;
+    }
+    ASSERT_STREQ( loaded.m_style.str(), "lines" );
+}
+
+TEST( Report, NativeGraph )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using G = Graph< V >;
+
+    for( G::RankDirection direction : { G::RankDirection::LR, G::RankDirection::TB, G::RankDirection::BT } )
+    {
+        G graph;
+        graph.m_rankDirection = direction;
+        for( int i = 0; i != 6; ++i )
+        {
+            graph.m_nodes.push_back( G::Node{ { { "Node <"s + std::to_string( i ) + ">"s, i }, { "Row"s } } } );
+        }
+        graph.m_nodes[ 2 ].m_bookmark = "bookmark"s;
+
+        // chain with a cycle, a long edge, a self loop and an edge ignored in layout
+        for( std::size_t i = 0; i != 4; ++i )
+        {
+            graph.m_edges.push_back( G::Edge{ i, i + 1U } );
+        }
+        graph.m_edges.push_back( G::Edge{ 4, 1, Colour::red, G::Edge::Style::dashed } );
+        graph.m_edges.push_back( G::Edge{ 0, 4 } );
+        graph.m_edges.back().m_label = std::vector< V >{ "Label"s };
+        graph.m_edges.push_back( G::Edge{ 3, 3 } );
+        graph.m_edges.push_back( G::Edge{ 5, 0, Colour::black, G::Edge::Style::dotted, true } );
+        graph.m_edges.push_back( G::Edge{ 2, 5, Colour::black, G::Edge::Style::invis } );
+        graph.m_edges.back().m_label = std::vector< V >{ "Hidden"s };
+        graph.m_subgraphs.push_back( G::Subgraph{ { { "Cluster"s } }, { 1, 2 } } );
+
+        const Container< V > c = graph;
+
+        std::ostringstream os;
+        {
+            HTMLTemplateEngine templateEngine{ true };
+            templateEngine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+            renderHTML( c, os, templateEngine );
+        }
+        const std::string str = os.str();
+
+        const auto count = [ &str ]( const std::string& strSearch )
+        {
+            std::size_t szCount = 0U;
+            for( auto szPos = str.find( strSearch ); szPos != std::string::npos;
+                 szPos      = str.find( strSearch, szPos + 1U ) )
+            {
+                ++szCount;
+            }
+            return szCount;
+        };
+        ASSERT_EQ( count( "<svg" ), 1U );
+        ASSERT_EQ( count( "<g class=\"node\">" ), 6U );
+        ASSERT_EQ( count( "<g class=\"cluster\">" ), 1U );
+        ASSERT_EQ( count( ">Node &lt;3&gt;</text>" ), 1U );
+        ASSERT_EQ( count( "<text id=\"bookmark\"" ), 1U );
+        ASSERT_EQ( count( ">Cluster</text>" ), 1U );
+        ASSERT_EQ( count( ">Label</text>" ), 1U );
+        // the invisible edge and its label are not drawn
+        ASSERT_EQ( count( ">Hidden</text>" ), 0U );
+        ASSERT_EQ( count( "<path " ), 8U );
+        ASSERT_EQ( count( "<polygon " ), 8U );
+        ASSERT_EQ( count( "stroke-dasharray=\"5,2\" fill=\"none\" d=" ), 1U );
+        ASSERT_EQ( count( "stroke-dasharray=\"1,5\"" ), 1U );
+    }
+
+    // larger graphs fall back to graphviz
+    {
+        G graph;
+        for( int i = 0; i != 3; ++i )
+        {
+            graph.m_nodes.push_back( G::Node{ { { "Node"s, i } } } );
+        }
+        const Container< V > c = graph;
+
+        std::ostringstream os;
+        {
+            HTMLTemplateEngine templateEngine{ true };
+            templateEngine.setGraphBackend( HTMLTemplateEngine::eNativeGraph, 2U );
+            renderHTML( c, os, templateEngine );
+        }
+        ASSERT_EQ( os.str().find( "<g class=\"node\">" ), std::string::npos );
+        ASSERT_NE( os.str().find( "<svg" ), std::string::npos );
+    }
+}
+
+TEST( Report, SVGCache )
+{
+    using namespace report;
+
+    // the name the cache had when it only held svgs still compiles
+    static_assert( std::is_same_v< SVGCache, ContentCache > );
+
+    const auto c        = makeProcessReport();
+    const auto cacheDir  = boost::filesystem::temp_directory_path() / "report_svg_cache_test";
+    boost::filesystem::remove_all( cacheDir );
+
+    std::ostringstream osUncached;
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        renderHTML( c, osUncached, templateEngine );
+    }
+
+    for( std::size_t szMisses : { 16U, 0U } )
+    {
+        // a new cache each time to load the entries persisted by the previous one
+        ContentCache       cache( cacheDir );
+        std::ostringstream osCached;
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setSVGCache( &cache );
+        renderHTML( c, osCached, templateEngine );
+        ASSERT_EQ( osUncached.str(), osCached.str() );
+        ASSERT_EQ( cache.getStatistics().szMisses, szMisses );
+        ASSERT_EQ( cache.getStatistics().szHits, 16U - szMisses );
+    }
+
+    // least recently used entries are evicted beyond the size limit
+    {
+        ContentCache cache( cacheDir, 10U );
+        ASSERT_EQ( cache.getStatistics().szEvictions, 15U );
+        cache.store( sha256( "one" ), "0123456789" );
+        cache.store( sha256( "two" ), "0123456789" );
+        ASSERT_EQ( cache.getTotalBytes(), 10U );
+        ASSERT_FALSE( cache.load( sha256( "one" ) ).has_value() );
+        ASSERT_EQ( cache.load( sha256( "two" ) ).value(), "0123456789" );
+    }
+
+    // temporary files of interrupted stores are removed once stale but not while they may be in progress
+    {
+        const auto stalePath  = cacheDir / "stale.tmp";
+        const auto recentPath = cacheDir / "recent.tmp";
+        std::ofstream( stalePath.string() ) << "partial";
+        std::ofstream( recentPath.string() ) << "partial";
+        boost::filesystem::last_write_time( stalePath, std::time( nullptr ) - 24 * 60 * 60 );
+        ContentCache cache( cacheDir );
+        ASSERT_FALSE( boost::filesystem::exists( stalePath ) );
+        ASSERT_TRUE( boost::filesystem::exists( recentPath ) );
+    }
+    boost::filesystem::remove_all( cacheDir );
+}
+
+#ifndef _WIN32
+TEST( Report, ProcessTimeout )
+{
+    using namespace report;
+
+    ASSERT_EQ( runExternalProcess( "echo", { "hello" }, {}, std::chrono::seconds( 10 ) ).strOutput, "hello\n" );
+    ASSERT_THROW(
+        runExternalProcess( "sleep", { "10" }, {}, std::chrono::milliseconds( 100 ) ), std::runtime_error );
+}
+
+TEST( Report, ProcessInput )
+{
+    using namespace report;
+
+    // larger than any pipe buffer so input and output must be transferred concurrently
+    std::string strInput;
+    for( int i = 0; strInput.size() < 1024U * 1024U; ++i )
+    {
+        strInput.append( "line " + std::to_string( i ) + "\n" );
+    }
+    const ProcessResult result = runExternalProcess( "cat", {}, strInput, std::chrono::seconds( 10 ) );
+    ASSERT_EQ( result.iExitCode, 0 );
+    ASSERT_EQ( result.strOutput, strInput );
+
+    // a program that exits without reading its input does not take down the caller
+    ASSERT_EQ( runExternalProcess( "true", {}, strInput, std::chrono::seconds( 10 ) ).iExitCode, 0 );
+}
+#endif
+
+TEST( Report, ConcurrentRender )
+{
+    using namespace report;
+
+    const std::vector< Container< TestValue > > reports = { makeProcessReport(), makeTextReport() };
+
+    ThreadPool pool( 4 );
+    for( bool bNative : { true, false } )
+    {
+        // one engine shared by every render
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setThreadPool( &pool, 1U );
+        if( bNative )
+        {
+            templateEngine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+            templateEngine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+        }
+        else
+        {
+            templateEngine.setMaxProcesses( 3U );
+            templateEngine.setBatchGraphs( true );
+            templateEngine.setPlotBackend( HTMLTemplateEngine::eGNUPlotCoProcess );
+        }
+
+        std::vector< std::string > serial;
+        for( const auto& c : reports )
+        {
+            std::ostringstream osSerial;
+            renderHTML( c, osSerial, templateEngine );
+            serial.push_back( osSerial.str() );
+        }
+
+        const std::size_t          szThreads = 8U, szIterations = bNative ? 8U : 2U;
+        std::vector< std::string > failures( szThreads );
+        std::vector< std::thread > threads;
+        for( std::size_t szThread = 0U; szThread != szThreads; ++szThread )
+        {
+            threads.emplace_back(
+                [ & ]( std::size_t szIndex )
+                {
+                    for( std::size_t i = 0U; i != szIterations; ++i )
+                    {
+                        const std::size_t  szReport = ( szIndex + i ) % reports.size();
+                        std::ostringstream osConcurrent;
+                        renderHTML( reports[ szReport ], osConcurrent, templateEngine );
+                        if( osConcurrent.str() != serial[ szReport ] )
+                        {
+                            failures[ szIndex ] = "Report " + std::to_string( szReport ) + " differs";
+                            return;
+                        }
+                    }
+                },
+                szThread );
+        }
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+        for( const auto& strFailure : failures )
+        {
+            ASSERT_TRUE( strFailure.empty() ) << strFailure;
+        }
+    }
+}
+
+TEST( Report, SVGBookmarks )
+{
+    using namespace report;
+
+    const std::string strGraphviz
+        = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n<svg>\n"
+          "<g id=\"a_node1_0\"><a xlink:href=\"#first\" xlink:title=\"&lt;TABLE&gt;\">\n"
+          "<polygon points=\"0,0 1,1\"/>\n<text text-anchor=\"start\" x=\"1\">first</text>\n</a>\n</g>\n"
+          "<text x=\"2\">plain &lt;g</text>\n"
+          "<g id=\"a_second\"><a xlink:href=\"#second\">\n<text x=\"3\">second</text>\n</a>\n</g>\n</svg>\n";
+    const std::string strExpected
+        = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n<svg>\n"
+          "<g><a xlink:href=\"#first\" xlink:title=\"&lt;TABLE&gt;\">\n"
+          "<polygon points=\"0,0 1,1\"/>\n<text id=\"node1_0\" text-anchor=\"start\" x=\"1\">first</text>\n</a>\n</g>\n"
+          "<text x=\"2\">plain &lt;g</text>\n"
+          "<g><a xlink:href=\"#second\">\n<text id=\"second\" x=\"3\">second</text>\n</a>\n</g>\n</svg>\n";
+
+    std::string strOutput;
+    rewriteSVGBookmarks( strGraphviz, strOutput );
+    ASSERT_EQ( strOutput, strExpected );
+
+    // the result does not depend on how the svg is split between writes
+    for( std::size_t szChunk = 1U; szChunk != 16U; ++szChunk )
+    {
+        std::string         strChunked;
+        SVGBookmarkRewriter rewriter( strChunked );
+        for( std::size_t szPos = 0U; szPos < strGraphviz.size(); szPos += szChunk )
+        {
+            rewriter.write( std::string_view( strGraphviz ).substr( szPos, szChunk ) );
+        }
+        rewriter.finish();
+        ASSERT_EQ( strChunked, strExpected ) << "chunk size " << szChunk;
+    }
+}
+
+TEST( Report, OutputSink )
+{
+    using namespace report;
+
+    const auto c = makeTextReport();
+
+    std::ostringstream osExpected;
+    renderHTML( c, osExpected );
+    const std::string strExpected = osExpected.str();
+
+    // chunks small enough for writes to span several and to pass larger ones through in place
+    for( std::size_t szChunkSize : { 1U, 7U, 64U, 4096U } )
+    {
+        std::ostringstream osChunked;
+        StreamSink         sink( osChunked );
+        {
+            OutputStream os( sink, szChunkSize, 3U );
+            renderHTML( c, os );
+        }
+        ASSERT_EQ( osChunked.str(), strExpected ) << "chunk size " << szChunkSize;
+    }
+
+    {
+        const auto filePath = boost::filesystem::temp_directory_path() / "report_output_sink_test.html";
+        {
+            FileSink file( filePath );
+            renderHTML( c, file );
+        }
+        std::string strFile;
+        boost::filesystem::loadAsciiFile( filePath, strFile );
+        boost::filesystem::remove( filePath );
+        ASSERT_EQ( strFile, strExpected );
+    }
+
+#ifndef _WIN32
+    {
+        int sockets[ 2 ];
+        ASSERT_EQ( ::socketpair( AF_UNIX, SOCK_STREAM, 0, sockets ), 0 );
+        std::string strReceived;
+        std::thread reader(
+            [ &strReceived, iSocket = sockets[ 1 ] ]()
+            {
+                char buffer[ 4096 ];
+                for( ssize_t szRead; ( szRead = ::read( iSocket, buffer, sizeof( buffer ) ) ) > 0; )
+                {
+                    strReceived.append( buffer, static_cast< std::size_t >( szRead ) );
+                }
+            } );
+        {
+            SocketSink socket( sockets[ 0 ] );
+            renderHTML( c, socket );
+        }
+        ::close( sockets[ 0 ] );
+        reader.join();
+        ::close( sockets[ 1 ] );
+        ASSERT_EQ( strReceived, strExpected );
+    }
+#endif
+
+#ifdef REPORT_WITH_ZLIB
+    {
+        std::ostringstream osCompressed;
+        {
+            StreamSink stream( osCompressed );
+            GZipSink   gzip( stream );
+            renderHTML( c, gzip );
+        }
+        const std::string strCompressed = osCompressed.str();
+        ASSERT_LT( strCompressed.size(), strExpected.size() );
+
+        z_stream stream{};
+        ASSERT_EQ( inflateInit2( &stream, 15 + 16 ), Z_OK );
+        std::string strInflated( strExpected.size() + 1U, '\0' );
+        stream.next_in   = reinterpret_cast< Bytef* >( const_cast< char* >( strCompressed.data() ) );
+        stream.avail_in  = static_cast< uInt >( strCompressed.size() );
+        stream.next_out  = reinterpret_cast< Bytef* >( strInflated.data() );
+        stream.avail_out = static_cast< uInt >( strInflated.size() );
+        ASSERT_EQ( inflate( &stream, Z_FINISH ), Z_STREAM_END );
+        strInflated.resize( stream.total_out );
+        inflateEnd( &stream );
+        ASSERT_EQ( strInflated, strExpected );
+    }
+#endif
+}
+
+namespace
+{
+struct Point
+{
+    int x, y;
+};
+std::ostream& operator<<( std::ostream& os, const Point& point )
+{
+    return os << '(' << point.x << ',' << point.y << ')';
+}
+} // namespace
+
+TEST( Report, FormatValue )
+{
+    using namespace report;
+
+    using V = std::variant< int, unsigned long, double, bool, char, std::string, const char*, Foobar, Point >;
+
+    std::string strBuffer;
+    ASSERT_EQ( formatValue( V{ -42 }, strBuffer ), "-42" );
+    ASSERT_EQ( formatValue( V{ 18446744073709551615UL }, strBuffer ), "18446744073709551615" );
+    ASSERT_EQ( formatValue( V{ 0.1 }, strBuffer ), "0.1" );
+    ASSERT_EQ( formatValue( V{ 1.5 }, strBuffer ), "1.5" );
+    ASSERT_EQ( formatValue( V{ true }, strBuffer ), "1" );
+    ASSERT_EQ( formatValue( V{ 'x' }, strBuffer ), "x" );
+    ASSERT_EQ( formatValue( V{ eTwo }, strBuffer ), "Two" );
+    ASSERT_EQ( formatValue( V{ Point{ 1, 2 } }, strBuffer ), "(1,2)" );
+
+    // timings keep every digit rather than the stream default of six significant digits
+    ASSERT_EQ( formatValue( V{ 1234567.891 }, strBuffer ), "1234567.891" );
+    ASSERT_EQ( toString( V{ 1234567.891 } ), "1234567.891" );
+
+    // strings are not copied
+    const V str = std::string( "text" );
+    ASSERT_EQ( formatValue( str, strBuffer ).data(), std::get< std::string >( str ).data() );
+    ASSERT_EQ( formatValue( V{ "literal" }, strBuffer ), "literal" );
+}
+
+namespace
+{
+using ArenaValue = std::variant< int, double, std::pmr::string >;
+} // namespace
+
+// report trees of ArenaValue use std::pmr::vector throughout
+template <>
+struct report::ContainerTraits< ArenaValue > : report::PMRContainerTraits
+{
+};
+
+namespace
+{
+template < typename V, typename String >
+report::Container< V > makeTableReport()
+{
+    using namespace report;
+
+    using B = Branch< V >;
+    using L = Line< V >;
+    using M = Multiline< V >;
+    using T = Table< V >;
+
+    B root{ { String( "Report.Arena" ) } };
+    for( int i = 0; i != 10; ++i )
+    {
+        T table{ { String( "Index" ), String( "Value" ), String( "Text" ) } };
+        for( int j = 0; j != 10; ++j )
+        {
+            table.m_rows.push_back(
+                { L{ j }, L{ i * 0.5 + j }, M{ { String( "a long string value & more " ), j, String( "<end>" ) } } } );
+        }
+        root.m_elements.push_back( std::move( table ) );
+    }
+    return root;
+}
+
+// counts the bytes a monotonic arena requests from upstream
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    std::size_t szBytes = 0U;
+
+private:
+    void* do_allocate( std::size_t szSize, std::size_t szAlign ) override
+    {
+        szBytes += szSize;
+        return std::pmr::new_delete_resource()->allocate( szSize, szAlign );
+    }
+    void do_deallocate( void* p, std::size_t szSize, std::size_t szAlign ) override
+    {
+        std::pmr::new_delete_resource()->deallocate( p, szSize, szAlign );
+    }
+    bool do_is_equal( const std::pmr::memory_resource& other ) const noexcept override { return this == &other; }
+};
+} // namespace
+
+TEST( Report, ArenaReport )
+{
+    using namespace report;
+
+    std::ostringstream osExpected;
+    renderHTML( makeTableReport< TestValue, std::string >(), osExpected );
+
+    CountingResource                    upstream;
+    std::pmr::monotonic_buffer_resource arena( &upstream );
+    {
+        // the tree is built in the arena by making it the default resource while building
+        std::pmr::memory_resource* pPrevious = std::pmr::set_default_resource( &arena );
+        const auto                 report    = makeTableReport< ArenaValue, std::pmr::string >();
+        std::pmr::set_default_resource( pPrevious );
+
+        const auto& root = std::get< Branch< ArenaValue > >( report );
+        ASSERT_EQ( root.m_elements.get_allocator().resource(), &arena );
+        ASSERT_EQ( std::get< Table< ArenaValue > >( root.m_elements.back() ).m_rows.get_allocator().resource(), &arena );
+        ASSERT_GT( upstream.szBytes, 0U );
+
+        std::ostringstream osArena;
+        renderHTML( report, osArena );
+        ASSERT_EQ( osArena.str(), osExpected.str() );
+    }
+    arena.release();
+}
+
+TEST( Report, BoxedElements )
+{
+    using namespace report;
+    using namespace std::string_literals;
+    using V = std::variant< int, double, std::string >;
+    using L = Line< V >;
+
+    // the url and bookmark are out of line so cells are not sized for them
+    ASSERT_LT( sizeof( Container< V > ), sizeof( std::optional< URL > ) );
+
+    L line{ "Text"s, fromString( "https://example.com/report" ), "bookmark"s };
+    ASSERT_TRUE( line.m_url.has_value() );
+    ASSERT_EQ( std::get< std::string >( line.m_bookmark.value() ), "bookmark" );
+
+    L plain{ "Text"s, std::nullopt };
+    ASSERT_FALSE( plain.m_url.has_value() );
+    ASSERT_FALSE( plain.m_bookmark );
+    ASSERT_THROW( plain.m_bookmark.value(), std::bad_optional_access );
+
+    // copies are deep
+    L copy          = line;
+    copy.m_bookmark = "other"s;
+    ASSERT_EQ( std::get< std::string >( line.m_bookmark.value() ), "bookmark" );
+    ASSERT_EQ( std::get< std::string >( *copy.m_bookmark ), "other" );
+
+    std::stringstream ss;
+    {
+        const Boxed< std::string >    empty;
+        boost::archive::text_oarchive archive( ss );
+        archive << line.m_url << empty;
+    }
+    Boxed< URL >         loadedURL;
+    Boxed< std::string > loadedEmpty = "text"s;
+    {
+        boost::archive::text_iarchive archive( ss );
+        archive >> loadedURL >> loadedEmpty;
+    }
+    ASSERT_EQ( loadedURL->buffer(), line.m_url->buffer() );
+    ASSERT_FALSE( loadedEmpty.has_value() );
+
+    // archives written with the std::optional members that Boxed replaced still load
+    std::stringstream ssOptional;
+    {
+        const std::optional< URL >         url = line.m_url.value();
+        const std::optional< std::string > empty;
+        boost::archive::text_oarchive      archive( ssOptional );
+        archive << url << empty;
+    }
+    ASSERT_EQ( ssOptional.str(), ss.str() );
+    loadedURL   = std::nullopt;
+    loadedEmpty = "text"s;
+    {
+        boost::archive::text_iarchive archive( ssOptional );
+        archive >> loadedURL >> loadedEmpty;
+    }
+    ASSERT_EQ( loadedURL->buffer(), line.m_url->buffer() );
+    ASSERT_FALSE( loadedEmpty.has_value() );
+}
+
+TEST( Report, InternedStrings )
+{
+    using namespace report;
+
+    StringPool           pool;
+    const InternedString heading = pool.intern( "Time < 10ms & \"fast\"" );
+    ASSERT_EQ( heading.str(), "Time < 10ms & \"fast\"" );
+    ASSERT_EQ( heading.escaped(), "Time &lt; 10ms &amp; &quot;fast&quot;" );
+
+    // identical strings share one entry
+    const InternedString again = pool.intern( std::string( "Time < 10ms & \"fast\"" ) );
+    ASSERT_EQ( again.str().data(), heading.str().data() );
+    ASSERT_EQ( again, heading );
+    ASSERT_NE( pool.intern( "other" ), heading );
+    ASSERT_EQ( pool.size(), 2U );
+
+    // equal text from different pools still compares equal
+    ASSERT_EQ( InternedString( "other" ), pool.intern( "other" ) );
+    ASSERT_EQ( InternedString(), InternedString( "" ) );
+
+    {
+        std::vector< std::thread > threads;
+        for( int i = 0; i != 4; ++i )
+        {
+            threads.emplace_back(
+                [ &pool ]()
+                {
+                    for( int j = 0; j != 1000; ++j )
+                    {
+                        pool.intern( "name" + std::to_string( j % 100 ) );
+                    }
+                } );
+        }
+        for( auto& thread : threads )
+        {
+            thread.join();
+        }
+    }
+    ASSERT_EQ( pool.size(), 102U );
+
+    // renders exactly as the same report of std::string
+    using InternedValue = std::variant< int, double, InternedString >;
+    std::ostringstream osExpected, osInterned;
+    renderHTML( makeTableReport< TestValue, std::string >(), osExpected );
+    renderHTML( makeTableReport< InternedValue, InternedString >(), osInterned );
+    ASSERT_EQ( osInterned.str(), osExpected.str() );
+}
+
+TEST( Report, BinaryReport )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using G = Graph< V >;
+    using P = Plot< V >;
+
+    G graph;
+    graph.m_nodes.push_back( G::Node{ { { "First"s, 1 } } } );
+    graph.m_nodes.push_back( G::Node{ { { "Second"s, eTwo } } } );
+    graph.m_nodes[ 1 ].m_bookmark = "second"s;
+    graph.m_edges.push_back( G::Edge{ 0, 1, Colour::red, G::Edge::Style::dashed } );
+    graph.m_edges.back().m_label = std::vector< V >{ "Label"s };
+    graph.m_subgraphs.push_back( G::Subgraph{ { { "Cluster"s } }, { 0, 1 } } );
+
+    P plot{ { "Plot"s }, {}, P::Style::lines };
+    for( int i = 0; i != 10; ++i )
+    {
+        plot.m_points.push_back( { i, 0.5 * i } );
+    }
+
+    const Container< V > report = B{ { "Root"s }, { makeTextReport(), graph, plot } };
+
+    const boost::filesystem::path filePath = g_resultDir / "binary_report.report";
+    {
+        std::ofstream file( filePath.string(), std::ios::binary );
+        writeBinaryReport( report, file );
+    }
+
+    const auto render = []( const Container< V >& container )
+    {
+        HTMLTemplateEngine templateEngine{ true };
+        templateEngine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+        templateEngine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+        std::ostringstream os;
+        renderHTML( container, os, templateEngine );
+        return os.str();
+    };
+
+    const BinaryReport< V > binaryReport( filePath );
+    const auto              root = binaryReport.root();
+    ASSERT_TRUE( root.is< B >() );
+    ASSERT_EQ( root.label(), std::vector< V >{ "Root"s } );
+
+    // navigate without loading the graph or plot
+    const auto elements = root.elements();
+    ASSERT_EQ( elements.size(), 3U );
+    ASSERT_TRUE( elements[ 1 ].is< G >() );
+    ASSERT_TRUE( elements[ 2 ].is< P >() );
+    const auto textElements = elements[ 0 ].elements();
+    ASSERT_EQ( textElements.size(), 4U );
+    ASSERT_TRUE( textElements[ 2 ].is< Table< V > >() );
+    ASSERT_EQ( textElements[ 2 ].label(), ( std::vector< V >{ "H1"s, "H2"s } ) );
+    const auto rows = textElements[ 2 ].rows();
+    ASSERT_EQ( rows.size(), 2U );
+    ASSERT_TRUE( rows[ 1 ][ 1 ].is< Multiline< V > >() );
+
+    // subtrees and the whole report load back to the same html
+    ASSERT_EQ( render( elements[ 0 ].load() ), render( makeTextReport() ) );
+    ASSERT_EQ( render( elements[ 1 ].load() ), render( graph ) );
+    ASSERT_EQ( render( binaryReport.load() ), render( report ) );
+
+    const G loadedGraph = std::get< G >( elements[ 1 ].load() );
+    ASSERT_EQ( loadedGraph.m_edges.back().m_label.value(), std::vector< V >{ "Label"s } );
+    ASSERT_EQ( std::get< std::string >( loadedGraph.m_nodes[ 1 ].m_bookmark.value() ), "second" );
+
+    // truncated files are rejected
+    std::string strData;
+    boost::filesystem::loadAsciiFile( filePath, strData );
+    const boost::filesystem::path truncatedPath = g_resultDir / "truncated.report";
+    {
+        std::ofstream file( truncatedPath.string(), std::ios::binary );
+        file.write( strData.data(), static_cast< std::streamsize >( strData.size() / 2U ) );
+    }
+    ASSERT_THROW( BinaryReport< V >{ truncatedPath }, std::runtime_error );
+
+    // as are branches that list their own record among their elements
+    const boost::filesystem::path cyclicPath = g_resultDir / "cyclic.report";
+    {
+        std::ostringstream osCyclic;
+        BinaryReportWriter writer( osCyclic );
+
+        const std::uint64_t          uiSelf = osCyclic.str().size();
+        std::uint8_t                 uiType = detail::VariantIndex< B, Container< V > >::value;
+        ValueVector< V >             label;
+        Boxed< V >                   bookmark;
+        std::vector< std::uint64_t > offsets{ uiSelf };
+        std::string                  strRecord;
+        BinaryOArchive               archive( strRecord );
+        archive& uiType;
+        archive& label;
+        archive& bookmark;
+        archive& offsets;
+        ASSERT_EQ( writer.append( strRecord ), uiSelf );
+        writer.finish( uiSelf );
+
+        std::ofstream     file( cyclicPath.string(), std::ios::binary );
+        const std::string strCyclic = osCyclic.str();
+        file.write( strCyclic.data(), static_cast< std::streamsize >( strCyclic.size() ) );
+    }
+    const BinaryReport< V > cyclicReport( cyclicPath );
+    ASSERT_THROW( cyclicReport.root().elements(), std::runtime_error );
+    ASSERT_THROW( cyclicReport.load(), std::runtime_error );
+}
+
+TEST( Report, ContainerHash )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+
+    const Container< V > report = makeTextReport();
+    ASSERT_EQ( hashContainer( report ), hashContainer( makeTextReport() ) );
+
+    // a change alters the digests on its path to the root only
+    Container< V > changed = makeTextReport();
+    {
+        B& nested = std::get< B >( std::get< B >( changed ).m_elements[ 1 ] );
+        std::get< Multiline< V > >( nested.m_elements[ 0 ] ).m_colour = Colour::blue;
+    }
+    ASSERT_NE( hashContainer( changed ), hashContainer( report ) );
+    const auto& elements        = std::get< B >( report ).m_elements;
+    const auto& changedElements = std::get< B >( changed ).m_elements;
+    ASSERT_NE( hashContainer( changedElements[ 1 ] ), hashContainer( elements[ 1 ] ) );
+    ASSERT_EQ( hashContainer( changedElements[ 2 ] ), hashContainer( elements[ 2 ] ) );
+
+    // field boundaries are part of the hash
+    const Container< V > ab = Multiline< V >{ { "ab"s, "c"s } };
+    const Container< V > bc = Multiline< V >{ { "a"s, "bc"s } };
+    ASSERT_NE( hashContainer( ab ), hashContainer( bc ) );
+
+    // the single pass records the same digests for the subtrees of at least the given size
+    const ContainerDigests all = hashSubtrees( report, 0U );
+    ASSERT_EQ( all.at( &report ), hashContainer( report ) );
+    for( const auto& element : elements )
+    {
+        ASSERT_EQ( all.at( &element ), hashContainer( element ) );
+    }
+    const ContainerDigests large = hashSubtrees( report, 4U );
+    ASSERT_EQ( large.at( &report ), hashContainer( report ) );
+    ASSERT_EQ( large.count( &elements[ 0 ] ), 0U );
+    ASSERT_LT( large.size(), all.size() );
+}
+
+TEST( Report, FragmentCache )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using G = Graph< V >;
+    using L = Line< V >;
+    using T = Table< V >;
+
+    const auto makeReport = []( int iChanged )
+    {
+        B root{ { "Nightly"s } };
+        for( int i = 0; i != 4; ++i )
+        {
+            T table{ { "Benchmark"s, "Time"s } };
+            for( int j = 0; j != 50; ++j )
+            {
+                table.m_rows.push_back( { L{ "BM_"s + std::to_string( j ) }, L{ i * 100 + j + ( i == iChanged ) } } );
+            }
+            G graph;
+            for( int j = 0; j != 3; ++j )
+            {
+                graph.m_nodes.push_back( G::Node{ { { "Node"s, i, j } } } );
+            }
+            graph.m_edges.push_back( G::Edge{ 0, 1 } );
+            graph.m_edges.push_back( G::Edge{ 1, 2 } );
+            root.m_elements.push_back( B{ { "Section"s, i }, { table, graph } } );
+        }
+        return Container< V >{ root };
+    };
+
+    for( const bool bDeferred : { false, true } )
+    {
+        const auto render = [ bDeferred ]( const Container< V >& report, ContentCache* pCache )
+        {
+            HTMLTemplateEngine engine{ true };
+            engine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+            engine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+            if( bDeferred )
+            {
+                engine.setMaxProcesses( 2 );
+            }
+            engine.setFragmentCache( pCache, 64U );
+            std::ostringstream os;
+            renderHTML( report, os, engine );
+            return os.str();
+        };
+
+        const boost::filesystem::path cacheDir = g_resultDir / "fragment_cache";
+        boost::filesystem::remove_all( cacheDir );
+        ContentCache cache( cacheDir, ContentCache::DEFAULT_MAX_BYTES, ".html" );
+
+        // root, 4 sections, 4 tables and 4 graphs
+        const std::string strExpected = render( makeReport( -1 ), nullptr );
+        ASSERT_EQ( render( makeReport( -1 ), &cache ), strExpected );
+        ASSERT_EQ( cache.getStatistics().szMisses, 13U );
+        ASSERT_EQ( cache.getStatistics().szHits, 0U );
+
+        // unchanged the root fragment is used as is
+        ASSERT_EQ( render( makeReport( -1 ), &cache ), strExpected );
+        ASSERT_EQ( cache.getStatistics().szHits, 1U );
+
+        // a changed table re-renders the root, its section and itself only
+        ASSERT_EQ( render( makeReport( 2 ), &cache ), render( makeReport( 2 ), nullptr ) );
+        ASSERT_EQ( cache.getStatistics().szMisses, 13U + 3U );
+        ASSERT_EQ( cache.getStatistics().szHits, 1U + 4U );
+    }
+}
+
+TEST( Report, HTMLPages )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using L = Line< V >;
+    using T = Table< V >;
+
+    const auto makeTable = []( int iSection, int iRows )
+    {
+        T table{ { "Benchmark"s, "Time"s } };
+        for( int j = 0; j != iRows; ++j )
+        {
+            table.m_rows.push_back( { L{ "BM_"s + std::to_string( j ) }, L{ iSection * 1000 + j } } );
+        }
+        return table;
+    };
+
+    // the last section is too large for one page and is split between its parts
+    B root{ { "Nightly"s } };
+    for( int i = 0; i != 6; ++i )
+    {
+        B section{ { "Section"s, i }, {}, V{ "section_"s + std::to_string( i ) } };
+        if( i == 5 )
+        {
+            for( int j = 0; j != 4; ++j )
+            {
+                section.m_elements.push_back(
+                    B{ { "Part"s, j }, { makeTable( i, 20 ) }, V{ "part_"s + std::to_string( j ) } } );
+            }
+        }
+        else
+        {
+            section.m_elements.push_back( makeTable( i, 40 ) );
+        }
+        root.m_elements.push_back( section );
+    }
+
+    const std::size_t             szPageSize = 12U * 1024U;
+    const boost::filesystem::path pagesDir   = g_resultDir / "html_pages";
+    boost::filesystem::remove_all( pagesDir );
+    const auto files = renderHTMLPages( Container< V >{ root }, pagesDir, szPageSize );
+
+    ASSERT_GT( files.size(), 4U );
+    ASSERT_EQ( files.front().filename(), HTMLPageWriter::INDEX_PAGE );
+    ASSERT_EQ( files.back().filename(), HTMLPageWriter::BOOKMARK_MAP );
+
+    std::string strBookmarks;
+    boost::filesystem::loadAsciiFile( files.back(), strBookmarks );
+
+    std::map< std::string, std::string > pages;
+    for( std::size_t i = 1U; i + 1U != files.size(); ++i )
+    {
+        ASSERT_EQ( files[ i ].filename(), HTMLPageWriter::pageName( i - 1U ) );
+        std::string strPage;
+        boost::filesystem::loadAsciiFile( files[ i ], strPage );
+        ASSERT_NE( strPage.find( "class=\"navigation\"" ), std::string::npos );
+        ASSERT_LT( strPage.size(), szPageSize + 8U * 1024U );
+        pages.insert( { files[ i ].filename().string(), strPage } );
+    }
+
+    // every bookmark is anchored on exactly one page which the map points to
+    std::map< std::string, std::string > bookmarkPages;
+    for( const std::string strBookmark : { "section_0", "section_3", "section_5", "part_0", "part_3" } )
+    {
+        const std::string strAnchor = "id=\"" + strBookmark + "\"";
+        std::string       strFound;
+        for( const auto& [ strName, strPage ] : pages )
+        {
+            if( strPage.find( strAnchor ) != std::string::npos )
+            {
+                ASSERT_TRUE( strFound.empty() ) << strBookmark;
+                strFound = strName;
+            }
+        }
+        ASSERT_FALSE( strFound.empty() ) << strBookmark;
+        ASSERT_NE( strBookmarks.find( "\"" + strBookmark + "\":\"" + strFound + "\"" ), std::string::npos );
+        bookmarkPages[ strBookmark ] = strFound;
+    }
+
+    // the split section is labelled on each of its pages
+    ASSERT_GT( std::count_if( pages.begin(), pages.end(),
+                              []( const auto& page ) { return page.second.find( "Section5" ) != std::string::npos; } ),
+               1 );
+
+    std::string strIndex;
+    boost::filesystem::loadAsciiFile( files.front(), strIndex );
+    for( const auto& [ strName, strPage ] : pages )
+    {
+        ASSERT_NE( strIndex.find( "href=\"" + strName + "\"" ), std::string::npos );
+    }
+
+    // a page is titled by its first and last branch even when other pieces come before them
+    {
+        const B                       titled{ { "Titled"s }, { L{ "intro"s }, B{ { "First"s } }, B{ { "Last"s } } } };
+        const boost::filesystem::path titledDir = g_resultDir / "html_pages_titled";
+        boost::filesystem::remove_all( titledDir );
+        const auto  titledFiles = renderHTMLPages( Container< V >{ titled }, titledDir );
+        std::string strTitledIndex;
+        boost::filesystem::loadAsciiFile( titledFiles.front(), strTitledIndex );
+        ASSERT_NE( strTitledIndex.find( ">Titled / First - Last<" ), std::string::npos ) << strTitledIndex;
+    }
+
+    // with deferred graphs an oversized branch is abandoned before the rest of its graphs are generated.
+    // Batched graphs stay pending until the render completes so none of the text reaches the page first.
+    {
+        using G = Graph< V >;
+
+        const int iGraphs = 32;
+        B         inner{ { "Inner"s } };
+        for( int i = 0; i != iGraphs; ++i )
+        {
+            G graph;
+            graph.m_nodes.push_back( G::Node{ { { "Deferred"s, i } } } );
+            inner.m_elements.push_back( L{ std::string( 2048U, 'x' ) } );
+            inner.m_elements.push_back( std::move( graph ) );
+        }
+        const B outer{ { "Outer"s }, { B{ { "Middle"s }, { std::move( inner ) } } } };
+
+        const boost::filesystem::path cacheDir    = g_resultDir / "html_pages_deferred_cache";
+        const boost::filesystem::path deferredDir = g_resultDir / "html_pages_deferred";
+        boost::filesystem::remove_all( cacheDir );
+        boost::filesystem::remove_all( deferredDir );
+        {
+            ContentCache       cache( cacheDir );
+            HTMLTemplateEngine templateEngine{ true };
+            templateEngine.setBatchGraphs( true );
+            templateEngine.setSVGCache( &cache );
+            renderHTMLPages( Container< V >{ outer }, deferredDir, templateEngine, 16U * 1024U );
+
+            // every graph is looked up once on its own page and again only by the abandoned renders
+            // of the enclosing branches that reached it before the page size was exceeded
+            const ContentCache::Statistics statistics = cache.getStatistics();
+            ASSERT_LT( statistics.szHits + statistics.szMisses, 2U * iGraphs );
+        }
+        boost::filesystem::remove_all( cacheDir );
+    }
+
+    // when node is available run the scripts of the first page against just enough of a browser
+    // for the onload handler to follow a bookmark on another page through the bookmark map
+    bool bNode = false;
+    try
+    {
+        bNode = runExternalProcess( "node", { "--version" }, {}, std::chrono::seconds( 10 ) ).iExitCode == 0;
+    }
+    catch( std::runtime_error& )
+    {
+    }
+    if( bNode )
+    {
+        const std::string& strPage = pages.at( HTMLPageWriter::pageName( 0U ) );
+        std::string        strScripts;
+        {
+            const std::string strOpen = "<script type=\"text/javascript\">", strClose = "</script>";
+            for( auto szOpen = strPage.find( strOpen ); szOpen != std::string::npos;
+                 szOpen      = strPage.find( strOpen, szOpen + 1U ) )
+            {
+                const auto szStart = szOpen + strOpen.size();
+                strScripts.append( strPage, szStart, strPage.find( strClose, szStart ) - szStart );
+            }
+        }
+        const std::string strProgram
+            = "var console  = { log: function() {} }\n"
+              "var window   = { location: { search: '', hash: '#part_3', pathname: '/html_pages/page_0.html',\n"
+              "                             replace: function( url ) { process.stdout.write( url ) } } }\n"
+              "var document = { getElementById: function() { return null },\n"
+              "                 querySelectorAll: function() { return [] },\n"
+              "                 addEventListener: function() {},\n"
+              "                 createElement: function() { return {} },\n"
+              "                 head: { appendChild: function( script ) { "
+              + strBookmarks + " script.onload() } } }\n" + strScripts + "\nwindow.onload()\n";
+        const ProcessResult result = runExternalProcess( "node", {}, strProgram, std::chrono::seconds( 10 ) );
+        ASSERT_EQ( result.iExitCode, 0 ) << result.strError;
+        ASSERT_EQ( result.strOutput, bookmarkPages.at( "part_3" ) + "#part_3" );
+    }
+}
+
+TEST( Report, HTMLAssets )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using G = Graph< V >;
+    using P = Plot< V >;
+
+    // the two plots are identical so share one svg
+    G graph;
+    for( int i = 0; i != 3; ++i )
+    {
+        graph.m_nodes.push_back( G::Node{ { { "Node"s, i } } } );
+    }
+    graph.m_nodes[ 1 ].m_bookmark = "node_bookmark"s;
+    graph.m_edges.push_back( G::Edge{ 0, 1 } );
+    P plot{ { "Plot"s }, {}, P::Style::lines };
+    for( int i = 0; i != 10; ++i )
+    {
+        plot.m_points.push_back( { i, 2 * i } );
+    }
+    const Container< V > c = B{ { "Assets"s }, { graph, plot, plot } };
+
+    const boost::filesystem::path assetDir = g_resultDir / "html_assets";
+    boost::filesystem::remove_all( assetDir );
+    HTMLAssets assets( assetDir, "assets" );
+
+    const auto render = [ & ]( bool bAssets, bool bDeferred )
+    {
+        HTMLTemplateEngine engine{ true };
+        engine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+        engine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+        if( bAssets )
+        {
+            engine.setAssets( &assets );
+        }
+        if( bDeferred )
+        {
+            engine.setMaxProcesses( 2 );
+        }
+        std::ostringstream os;
+        renderHTML( c, os, engine );
+        return os.str();
+    };
+
+    const std::string strInline = render( false, false );
+    ASSERT_NE( strInline.find( "<svg" ), std::string::npos );
+    ASSERT_NE( strInline.find( "<style>" ), std::string::npos );
+    ASSERT_NE( strInline.find( "function navigateTo(" ), std::string::npos );
+
+    const std::string strAssets = render( true, false );
+    ASSERT_EQ( render( true, true ), strAssets );
+    ASSERT_EQ( strAssets.find( "<svg" ), std::string::npos );
+    ASSERT_EQ( strAssets.find( "<style>" ), std::string::npos );
+    ASSERT_EQ( strAssets.find( "function navigateTo(" ), std::string::npos );
+    ASSERT_NE( strAssets.find( "data-bookmarks=\"[&quot;node_bookmark&quot;]\"" ), std::string::npos );
+    ASSERT_NE( strAssets.find( "style=\"width:600px;height:400px\"" ), std::string::npos );
+
+    // graph and plot svgs, the style and the script
+    std::map< std::string, std::size_t > extensions;
+    for( const auto& entry : boost::filesystem::directory_iterator( assetDir ) )
+    {
+        const std::string strName = entry.path().filename().string();
+        ASSERT_NE( strAssets.find( "\"assets/" + strName + "\"" ), std::string::npos ) << strName;
+        ++extensions[ entry.path().extension().string() ];
+    }
+    ASSERT_EQ( extensions[ ".svg" ], 2U );
+    ASSERT_EQ( extensions[ ".css" ], 1U );
+    ASSERT_EQ( extensions[ ".js" ], 1U );
+
+    // svgs from gnuplot and graphviz are replaced by their placeholders as each one completes
+    const auto renderProcesses = [ & ]( bool bDeferred )
+    {
+        HTMLTemplateEngine engine{ true };
+        engine.setAssets( &assets );
+        if( bDeferred )
+        {
+            engine.setMaxProcesses( 2 );
+            engine.setBatchGraphs( true );
+        }
+        std::ostringstream os;
+        renderHTML( c, os, engine );
+        return os.str();
+    };
+    const std::string strProcesses = renderProcesses( false );
+    ASSERT_EQ( strProcesses.find( "<svg" ), std::string::npos );
+    ASSERT_EQ( renderProcesses( true ), strProcesses );
+
+    // fragments cached while writing to one asset folder are not reused for another so that
+    // every folder still gets its svgs
+    const boost::filesystem::path fragmentDir = g_resultDir / "html_assets_fragments";
+    boost::filesystem::remove_all( fragmentDir );
+    ContentCache fragmentCache( fragmentDir );
+    const auto   renderFragments = [ & ]( const std::string& strName )
+    {
+        const boost::filesystem::path dir = g_resultDir / strName;
+        boost::filesystem::remove_all( dir );
+        HTMLAssets         folderAssets( dir, strName );
+        HTMLTemplateEngine engine{ true };
+        engine.setPlotBackend( HTMLTemplateEngine::eNativePlot );
+        engine.setGraphBackend( HTMLTemplateEngine::eNativeGraph );
+        engine.setAssets( &folderAssets );
+        engine.setFragmentCache( &fragmentCache, 1U );
+        std::ostringstream os;
+        renderHTML( c, os, engine );
+
+        std::size_t szSVGs = 0U;
+        for( const auto& entry : boost::filesystem::directory_iterator( dir ) )
+        {
+            if( entry.path().extension() == ".svg" )
+            {
+                ++szSVGs;
+                EXPECT_NE( os.str().find( "\"" + strName + "/" + entry.path().filename().string() + "\"" ),
+                           std::string::npos );
+            }
+        }
+        EXPECT_EQ( szSVGs, 2U ) << strName;
+        return os.str();
+    };
+    const std::string strFirst = renderFragments( "html_assets_a" );
+    renderFragments( "html_assets_b" );
+    ASSERT_EQ( renderFragments( "html_assets_a" ), strFirst );
+}
+
+TEST( Report, CollapsedBranches )
+{
+    using namespace std::string_literals;
+    using namespace report;
+
+    using V = TestValue;
+    using B = Branch< V >;
+    using L = Line< V >;
+
+    // the details are collapsed by depth and the long section by its number of elements
+    B root{ { "Root"s } };
+    for( int i = 0; i != 3; ++i )
+    {
+        B detail{ { "Detail"s, i }, { L{ "Detail line"s } } };
+        detail.m_elements.push_back( L{ "Bookmarked"s, std::nullopt, V{ "detail_"s + std::to_string( i ) } } );
+
+        B section{ { "Section"s, i }, { detail } };
+        for( int j = 0; j != ( i == 1 ? 50 : 5 ); ++j )
+        {
+            section.m_elements.push_back( L{ "Line "s + std::to_string( j ) } );
+        }
+        root.m_elements.push_back( section );
+    }
+    const Container< V > c = root;
+
+    const auto render = [ &c ]( ThreadPool* pPool, ContentCache* pCache )
+    {
+        HTMLTemplateEngine engine{ true };
+        engine.setCollapseBranches( 2U, 20U );
+        if( pPool )
+        {
+            engine.setThreadPool( pPool, 1U );
+        }
+        engine.setFragmentCache( pCache, 4U );
+        std::ostringstream os;
+        renderHTML( c, os, engine );
+        return os.str();
+    };
+
+    const std::string str = render( nullptr, nullptr );
+    const auto        count = [ &str ]( const std::string& strSearch )
+    {
+        std::size_t szCount = 0U;
+        for( auto szPos = str.find( strSearch ); szPos != std::string::npos; szPos = str.find( strSearch, szPos + 1U ) )
+        {
+            ++szCount;
+        }
+        return szCount;
+    };
+    ASSERT_EQ( count( "<template class=\"report_collapsed\">" ), 4U );
+    ASSERT_EQ( count( "</template>" ), 4U );
+    ASSERT_EQ( count( "report_expander\" onclick=\"expandBranch( this )\">Detail" ), 3U );
+    ASSERT_EQ( count( "report_expander\" onclick=\"expandBranch( this )\">Section1" ), 1U );
+    ASSERT_EQ( count( "report_expander\" onclick=\"expandBranch( this )\">Section0" ), 0U );
+
+    // bookmarks within collapsed branches are inert until revealed
+    const std::size_t szBookmark = str.find( "id=\"detail_0\"" );
+    ASSERT_NE( szBookmark, std::string::npos );
+    ASSERT_LT( str.rfind( "<template", szBookmark ), szBookmark );
+    ASSERT_GT( str.find( "</template>", szBookmark ), szBookmark );
+
+    // depth is followed by children rendered in parallel and by cached fragments
+    ThreadPool pool( 4 );
+    ASSERT_EQ( render( &pool, nullptr ), str );
+
+    const boost::filesystem::path cacheDir = g_resultDir / "collapsed_cache";
+    boost::filesystem::remove_all( cacheDir );
+    ContentCache cache( cacheDir, ContentCache::DEFAULT_MAX_BYTES, ".html" );
+    ASSERT_EQ( render( nullptr, &cache ), str );
+    ASSERT_EQ( render( nullptr, &cache ), str );
+    ASSERT_GT( cache.getStatistics().szHits, 0U );
+}